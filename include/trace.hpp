@@ -0,0 +1,169 @@
+#pragma once
+// Header-only tracing shared by mini-t, mini-explorer and text-editor.
+//
+// Call trace::init("<app>") at the top of main(). When TRACE_OUTPUT names a
+// file, spans, counters and instants are recorded and written there at exit
+// as Chrome trace JSON (load it in Perfetto or chrome://tracing). Otherwise
+// every macro costs one relaxed atomic load and a branch.
+//
+//   TRACE_SCOPE("load_directory");        // span until the end of the block
+//   TRACE_COUNTER("entries", n);          // sampled value
+//   TRACE_INSTANT("first frame");         // point in time
+//
+// Names must be string literals: only the pointer is stored.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace trace {
+
+struct Event {
+    const char *name;
+    char phase;       // 'X' complete span, 'C' counter, 'i' instant
+    uint64_t ts_ns;
+    uint64_t dur_ns;
+    double value;
+};
+
+// Written only by its own thread; count is published with release so the
+// exit-time dump can read a consistent prefix without taking a lock
+struct ThreadBuffer {
+    static constexpr size_t CAPACITY = 1 << 16;
+    Event events[CAPACITY];
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> dropped{0};
+    long tid = 0;
+};
+
+inline std::atomic<bool> enabled_flag{false};
+inline std::mutex registry_mutex;
+inline std::vector<ThreadBuffer*> registry;
+inline std::string output_path;
+inline std::string process_name;
+
+inline bool enabled() { return enabled_flag.load(std::memory_order_relaxed); }
+
+inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Buffers are registered once per thread and never freed, so events from
+// threads that already exited still make it into the dump
+inline ThreadBuffer* thread_buffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        buffer = new ThreadBuffer();
+        buffer->tid = syscall(SYS_gettid);
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(buffer);
+    }
+    return buffer;
+}
+
+inline void record(const char *name, char phase, uint64_t ts_ns, uint64_t dur_ns, double value) {
+    ThreadBuffer *buffer = thread_buffer();
+    size_t n = buffer->count.load(std::memory_order_relaxed);
+    if (n >= ThreadBuffer::CAPACITY) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[n] = {name, phase, ts_ns, dur_ns, value};
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+class Scope {
+public:
+    explicit Scope(const char *name) : name_(enabled() ? name : nullptr), start_ns_(name_ ? now_ns() : 0) {}
+    ~Scope() {
+        if (name_) record(name_, 'X', start_ns_, now_ns() - start_ns_, 0.0);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char *name_;
+    uint64_t start_ns_;
+};
+
+inline void counter(const char *name, double value) {
+    if (enabled()) record(name, 'C', now_ns(), 0, value);
+}
+
+inline void instant(const char *name) {
+    if (enabled()) record(name, 'i', now_ns(), 0, 0.0);
+}
+
+// For a point in time taken earlier on the now_ns() clock
+inline void instant_at(const char *name, uint64_t ts_ns) {
+    if (enabled()) record(name, 'i', ts_ns, 0, 0.0);
+}
+
+inline void write_json_string(FILE *out, const char *text) {
+    std::fputc('"', out);
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', out);
+        if ((unsigned char)*c >= 0x20) std::fputc(*c, out);
+    }
+    std::fputc('"', out);
+}
+
+inline void write_json() {
+    enabled_flag.store(false, std::memory_order_relaxed);
+    FILE *out = std::fopen(output_path.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "trace: cannot write %s\n", output_path.c_str());
+        return;
+    }
+
+    int pid = getpid();
+    std::fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":", pid);
+    write_json_string(out, process_name.c_str());
+    std::fprintf(out, "}}");
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (ThreadBuffer *buffer : registry) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const Event &e = buffer->events[i];
+            std::fprintf(out, ",\n{\"name\":");
+            write_json_string(out, e.name);
+            std::fprintf(out, ",\"ph\":\"%c\",\"pid\":%d,\"tid\":%ld,\"ts\":%.3f", e.phase, pid, buffer->tid, e.ts_ns / 1000.0);
+            if (e.phase == 'X') std::fprintf(out, ",\"dur\":%.3f", e.dur_ns / 1000.0);
+            else if (e.phase == 'C') std::fprintf(out, ",\"args\":{\"value\":%.17g}", e.value);
+            else std::fprintf(out, ",\"s\":\"t\"");
+            std::fprintf(out, "}");
+        }
+        uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped)
+            std::fprintf(stderr, "trace: thread %ld dropped %llu events (buffer full)\n",
+                         buffer->tid, (unsigned long long)dropped);
+    }
+    std::fprintf(out, "\n]}\n");
+    std::fclose(out);
+}
+
+inline void init(const char *name) {
+    const char *path = std::getenv("TRACE_OUTPUT");
+    if (!path || !*path || enabled()) return;
+    output_path = path;
+    process_name = name;
+    enabled_flag.store(true, std::memory_order_relaxed);
+    std::atexit(write_json);
+}
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::trace::Scope TRACE_CONCAT(trace_scope_, __COUNTER__)(name)
+#define TRACE_COUNTER(name, value) ::trace::counter(name, (double)(value))
+#define TRACE_INSTANT(name) ::trace::instant(name)
@@ -1,4 +1,5 @@
 #include "file_manager.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <fstream>
 #include <cstdio>
@@ -60,6 +61,7 @@ void show_error_dialog(GtkWidget *parent, const char *title, const char *message
 }
 
 void load_directory(FileManagerData *data, const char *path) {
+    TRACE_SCOPE("load_directory");
     DIR *dir = opendir(path);
     if (!dir) {
         char detailed_error[512];
@@ -76,8 +78,10 @@ void load_directory(FileManagerData *data, const char *path) {
     gtk_list_store_clear(data->list_store);
 
     struct dirent *entry;
+    int entries = 0;
     while ((entry = readdir(dir)) != nullptr) {
         if (std::strcmp(entry->d_name, ".") == 0) continue;
+        entries++;
 
         GtkTreeIter iter;
         gtk_list_store_append(data->list_store, &iter);
@@ -121,6 +125,7 @@ void load_directory(FileManagerData *data, const char *path) {
         g_free(size_str);
     }
     closedir(dir);
+    TRACE_COUNTER("directory entries", entries);
 }
 
 // -------------------- Callbacks --------------------
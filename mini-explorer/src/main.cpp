@@ -1,8 +1,10 @@
 #include "file_manager.hpp"
+#include "trace.hpp"
 #include <pwd.h>
 #include <unistd.h>
 
 int main(int argc, char *argv[]) {
+    trace::init("mini-explorer");
     gtk_init(&argc, &argv);
 
     FileManagerData data = {0};
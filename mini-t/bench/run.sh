@@ -0,0 +1,87 @@
+#!/bin/sh
+# Drive a real mini-t window through each workload and compare against
+# baseline.tsv, if one has been recorded. Needs a display, or xvfb-run to
+# provide a headless one.
+#
+# Usage: bench/run.sh [--record]
+#   BENCH_MB                 megabytes per throughput workload (default 32)
+#   BENCH_LATENCY_SAMPLES    keystrokes timed for latency (default 200)
+#   BENCH_TABS               shell tabs opened and closed for tabs.* (default 1000)
+#   BENCH_BACKGROUND_TABS    hidden tabs running ascii output at once (default 8)
+set -eu
+cd "$(dirname "$0")/.."
+
+MB=${BENCH_MB:-32}
+SAMPLES=${BENCH_LATENCY_SAMPLES:-200}
+TABS=${BENCH_TABS:-1000}
+BACKGROUND_TABS=${BENCH_BACKGROUND_TABS:-8}
+WORKLOAD="python3 $PWD/bench/workload.py"
+BASELINE=bench/baseline.tsv
+RESULTS=$(mktemp)
+trap 'rm -f "$RESULTS"' EXIT
+
+run_mini_t() {
+    if [ -n "${DISPLAY:-}${WAYLAND_DISPLAY:-}" ]; then
+        "$@"
+    elif command -v xvfb-run >/dev/null 2>&1; then
+        xvfb-run -a -s "-screen 0 1280x1024x24" "$@"
+    else
+        echo "bench: no display and xvfb-run not found" >&2
+        exit 1
+    fi
+}
+
+for kind in ascii longlines sgr unicode scroll; do
+    bytes=$($WORKLOAD "$kind" "$MB" | wc -c)
+    line=$(run_mini_t env MINI_T_BENCH="$WORKLOAD $kind $MB" MINI_T_SHELL_POOL=0 ./mini-t | grep '^bench')
+    echo "$line" | awk -F'\t' -v kind="$kind" -v bytes="$bytes" '{
+        printf "throughput.%s\t%.1f\tMB/s\n", kind, bytes / 1048576 / $3
+        printf "peak_rss.%s\t%d\tKB\n", kind, $4
+    }' >> "$RESULTS"
+done
+
+line=$(run_mini_t env MINI_T_BENCH="$WORKLOAD echo" MINI_T_BENCH_LATENCY_SAMPLES="$SAMPLES" MINI_T_SHELL_POOL=0 ./mini-t | grep '^bench')
+echo "$line" | awk -F'\t' '{
+    printf "latency.p50\t%.2f\tms\n", $3
+    printf "latency.p90\t%.2f\tms\n", $4
+    printf "latency.p99\t%.2f\tms\n", $5
+    printf "latency.max\t%.2f\tms\n", $6
+    printf "peak_rss.latency\t%d\tKB\n", $7
+}' >> "$RESULTS"
+
+# mini-t's CPU time with busy hidden tabs, with and without their throttling
+for throttle in 1 0; do
+    line=$(run_mini_t env MINI_T_BENCH="$WORKLOAD ascii $MB" MINI_T_BENCH_BACKGROUND="$BACKGROUND_TABS" \
+        MINI_T_BACKGROUND_THROTTLE=$throttle MINI_T_SHELL_POOL=0 ./mini-t | grep '^bench')
+    suffix=$([ "$throttle" = 1 ] && echo "" || echo ".unthrottled")
+    echo "$line" | awk -F'\t' -v suffix="$suffix" '{
+        printf "background.cpu%s\t%.2f\ts\n", suffix, $5
+        printf "background.seconds%s\t%.2f\ts\n", suffix, $4
+    }' >> "$RESULTS"
+done
+
+# RSS growth after opening and closing TABS tabs should stay near zero
+line=$(run_mini_t env MINI_T_BENCH_TABS="$TABS" MINI_T_SHELL_POOL=0 ./mini-t | grep '^bench')
+echo "$line" | awk -F'\t' '{
+    printf "tabs.seconds\t%.2f\ts\n", $4
+    printf "tabs.rss_growth\t%d\tKB\n", $6 - $5
+}' >> "$RESULTS"
+
+if [ "${1:-}" = "--record" ]; then
+    cp "$RESULTS" "$BASELINE"
+    echo "bench: recorded $BASELINE"
+fi
+
+# Metric, current value, baseline value and relative change
+if [ -f "$BASELINE" ]; then
+    awk -F'\t' 'NR == FNR { base[$1] = $2; next }
+        {
+            if ($1 in base && base[$1] != 0)
+                printf "%-22s %10s %-5s baseline %10s  %+6.1f%%\n", $1, $2, $3, base[$1], ($2 - base[$1]) * 100 / base[$1]
+            else
+                printf "%-22s %10s %-5s baseline %10s\n", $1, $2, $3, "-"
+        }' "$BASELINE" "$RESULTS"
+else
+    awk -F'\t' '{ printf "%-22s %10s %s\n", $1, $2, $3 }' "$RESULTS"
+    echo "bench: no $BASELINE to compare against; 'make bench-record' on the reference machine records one" >&2
+fi
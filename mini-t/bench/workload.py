@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Synthetic output for the mini-t benchmark.
+
+Usage: workload.py <ascii|longlines|sgr|unicode|scroll> <megabytes>
+       workload.py echo
+"""
+import os
+import sys
+import termios
+import tty
+
+BLOCK_BYTES = 64 * 1024
+
+
+def ascii_block():
+    line = "".join(chr(33 + i % 94) for i in range(79)) + "\n"
+    return line * (BLOCK_BYTES // len(line))
+
+
+def longlines_block():
+    line = ("the quick brown fox jumps over the lazy dog " * 100)[:4000] + "\n"
+    return line * (BLOCK_BYTES // len(line))
+
+
+def sgr_block():
+    words = []
+    for i in range(4000):
+        words.append("\033[1;38;5;%dm\033[48;5;%dmword%d\033[0m" % (i % 256, (i * 7) % 256, i))
+        if i % 8 == 7:
+            words.append("\n")
+    return " ".join(words)
+
+
+def unicode_block():
+    line = "héllo wörld Ελληνικά кириллица 日本語テキスト 한국어 é \U0001F600\U0001F680 ✓✗→\n"
+    return line * (BLOCK_BYTES // len(line.encode()))
+
+
+def scroll_block():
+    # Restrict scrolling to rows 5-20 so every newline scrolls a partial region
+    lines = "".join("region line %d\n" % i for i in range(2000))
+    return "\033[5;20r\033[20;1H" + lines + "\033[r"
+
+
+WORKLOADS = {
+    "ascii": ascii_block,
+    "longlines": longlines_block,
+    "sgr": sgr_block,
+    "unicode": unicode_block,
+    "scroll": scroll_block,
+}
+
+
+def generate(kind, megabytes):
+    block = WORKLOADS[kind]().encode()
+    total = megabytes * 1024 * 1024
+    out = sys.stdout.buffer
+    written = 0
+    while written < total:
+        out.write(block)
+        written += len(block)
+    out.flush()
+
+
+def echo():
+    # Echo each key straight back until the driver sends "q"
+    fd = sys.stdin.fileno()
+    saved = termios.tcgetattr(fd)
+    tty.setraw(fd)
+    try:
+        while True:
+            key = os.read(fd, 1)
+            if not key or key == b"q":
+                break
+            os.write(1, key)
+    finally:
+        termios.tcsetattr(fd, termios.TCSADRAIN, saved)
+
+
+def main():
+    if len(sys.argv) == 2 and sys.argv[1] == "echo":
+        echo()
+    elif len(sys.argv) == 3 and sys.argv[1] in WORKLOADS:
+        generate(sys.argv[1], int(sys.argv[2]))
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,9 @@
+#pragma once
+#include <gtk/gtk.h>
+
+// Sample every tab's foreground process group on a timer and show busy /
+// finished / new-output indicators in the tab labels
+void activity_start(GtkNotebook *notebook);
+
+// Hidden tabs are unmapped by the notebook; per-tab work can run less often there
+bool tab_in_background(GtkWidget *page);
@@ -0,0 +1,8 @@
+#pragma once
+#include <gtk/gtk.h>
+
+// Benchmark mode: MINI_T_BENCH holds the workload command to run in a tab
+// (in MINI_T_BENCH_BACKGROUND hidden tabs at once, if set), or
+// MINI_T_BENCH_TABS the number of tabs to open and close
+bool bench_enabled();
+void bench_start(GtkNotebook *notebook);
@@ -0,0 +1,39 @@
+#pragma once
+#include <glib.h>
+#include <string>
+
+// Runtime settings, read once from MINI_T_* environment variables
+struct MiniTConfig {
+    // Rows of history per tab; -1 is unlimited. VTE keeps only the live screen
+    // in RAM and pages older rows through compressed blocks in an unlinked
+    // temp file, so large values cost disk rather than memory.
+    glong scrollback_lines;
+
+    // Idle shells kept pre-spawned for new tabs (0 disables the pool), and how
+    // long to wait after a tab takes one before forking its replacement
+    glong shell_pool_size;
+    glong shell_pool_refill_ms;
+
+    // Session transcripts: log every new tab automatically, where to put the
+    // files, and whether to gzip them and prefix lines with a timestamp
+    bool session_log_all;
+    std::string session_log_dir;
+    bool session_log_compress;
+    bool session_log_timestamps;
+
+    // Bytes the cross-tab search index may use per tab, whatever the
+    // scrollback setting. Older rows are kept compressed, so this covers
+    // several times as much output; past it the oldest rows are evicted and
+    // the search window says how many rows it no longer covers.
+    size_t search_index_bytes;
+
+    // How often each tab's foreground process group is sampled from /proc
+    glong activity_interval_ms;
+
+    // Hidden tabs do their own per-output work (search indexing) less often.
+    // VTE never paints an unmapped page either way; turning this off is for
+    // measuring the difference (bench/run.sh).
+    bool background_throttle;
+};
+
+const MiniTConfig& mini_t_config();
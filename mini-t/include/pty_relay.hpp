@@ -0,0 +1,20 @@
+#pragma once
+#include <vte/vte.h>
+
+// Children run on a PTY of their own instead of the terminal's. A relay
+// thread copies their output to the terminal's PTY, and keystrokes back, and
+// on the way tees the raw output to the tab's session log. The log therefore
+// never depends on how fast VTE renders or how far the search index has read.
+struct PtyRelay;
+struct SessionLog;
+
+// Give terminal a fresh PTY fed from child_pty; nullptr (terminal untouched)
+// if one can't be set up
+PtyRelay* pty_relay_attach(VteTerminal *terminal, VtePty *child_pty);
+// The terminal is going away; the relay frees itself once its thread is done
+void pty_relay_release(PtyRelay *relay);
+
+// Hand log to the relay (nullptr stops logging). The relay closes the log it
+// replaces, so the caller must not touch that one afterwards.
+void pty_relay_set_log(PtyRelay *relay, SessionLog *log);
+SessionLog* pty_relay_log(const PtyRelay *relay);
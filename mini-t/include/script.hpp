@@ -0,0 +1,5 @@
+#pragma once
+#include <vte/vte.h>
+
+// Execute a script on the terminal's PTY and report its exit status and timings
+void run_script(VteTerminal *terminal, const char *path);
@@ -0,0 +1,7 @@
+#pragma once
+#include <gtk/gtk.h>
+#include <vte/vte.h>
+
+// Start indexing a tab's output; the index lives as long as the terminal
+void search_attach(VteTerminal *terminal);
+void on_search_tabs(GSimpleAction *action, GVariant *parameter, gpointer user_data);
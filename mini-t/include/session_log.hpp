@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Per-tab transcript written by a dedicated thread. The tab's PTY relay (see
+// pty_relay.hpp) copies raw output into a lock-free single-producer/single-
+// consumer ring and never waits on the disk: when the ring is full the chunk
+// is dropped and counted.
+struct SessionLog;
+
+struct SessionLogStats {
+    uint64_t written_bytes; // bytes handed to the file (before compression)
+    uint64_t dropped_writes;
+    uint64_t dropped_bytes;
+};
+
+// Returns nullptr if the file can't be created; compress writes gzip
+SessionLog* session_log_open(const std::string &path, bool compress, bool timestamps);
+// Queue a chunk of output as read from the PTY; with timestamps on, every
+// line that starts in it is stamped with the time the chunk arrived
+void session_log_write(SessionLog *log, const char *data, size_t len);
+SessionLogStats session_log_stats(const SessionLog *log);
+// Returns at once; the writer thread drains what is queued, closes the file
+// and frees the log. log must not be used afterwards.
+void session_log_close(SessionLog *log);
+// At exit: give logs that are still draining a few seconds to finish
+void session_log_shutdown();
@@ -0,0 +1,13 @@
+#pragma once
+#include <vte/vte.h>
+
+// Idle login shells spawned ahead of time so new tabs start at a prompt
+struct PooledShell {
+    VtePty *pty; // owned by the caller after shell_pool_take()
+    GPid pid;
+};
+
+// Begin warming shells once the first window is up
+void shell_pool_start();
+bool shell_pool_take(PooledShell *shell);
+void shell_pool_shutdown();
@@ -0,0 +1,46 @@
+#pragma once
+#include <gtk/gtk.h>
+#include <vte/vte.h>
+#include <vector>
+
+struct PtyRelay;
+
+// One notebook page: the terminal plus the child process and PTY behind it
+struct Tab {
+    guint id;
+    VteTerminal *terminal;
+    GPid pid;        // -1 until a child has been spawned or adopted
+    VtePty *pty;     // the child's own PTY, referenced while it runs
+    PtyRelay *relay; // copies pty to the terminal; nullptr if the child uses the terminal's
+    bool exited;
+    int exit_status; // raw wait status once exited
+    bool runs_shell; // false for script tabs, which are busy until they exit
+
+    // Label indicators and the last /proc sample, maintained by activity.cpp
+    GtkWidget *spinner;
+    GtkWidget *marker;
+    bool busy;
+    bool unseen;     // finished or printed something while in the background
+    GPid sampled_pgid;
+    gint64 sampled_us;
+    unsigned long long sampled_ticks;
+    unsigned long long sampled_rchar;
+    unsigned long long sampled_wchar;
+};
+
+// Register a terminal; the Tab is freed when the terminal is destroyed
+Tab* tab_attach(VteTerminal *terminal);
+Tab* tab_for(VteTerminal *terminal);
+const std::vector<Tab*>& all_tabs();
+void tab_set_child(VteTerminal *terminal, GPid pid, VtePty *pty, PtyRelay *relay);
+// status is the raw wait status; called for children whoever reaped them
+void tab_set_exited(VteTerminal *terminal, int status);
+
+// Append with a title + close button label and switch to it
+void tab_add(GtkNotebook *notebook, VteTerminal *terminal, const char *title);
+// Remove the page, hang up every process group in the child's session and reap it
+void tab_close(GtkNotebook *notebook, VteTerminal *terminal);
+// Closed tabs whose sessions haven't emptied yet
+int tab_reapers_pending();
+
+void on_diagnostics(GSimpleAction *action, GVariant *parameter, gpointer user_data);
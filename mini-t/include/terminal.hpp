@@ -5,6 +5,34 @@
 #include <unistd.h>
 #include <string>
 
+struct TerminalStyle {
+    PangoFontDescription *font;
+    GdkRGBA fg, bg, palette[16];
+    std::string shell;
+};
+
+const TerminalStyle& terminal_style();
+
+// Styled terminal with no child process attached yet
+VteTerminal* new_terminal(bool splash = true);
 VteTerminal* spawn_terminal(GtkWidget *parent, bool splash = true);
+
+// Run argv on a PTY of its own that a relay copies into terminal (see
+// pty_relay.hpp), so the tab can be logged. The child is not watched:
+// callers that want "child-exited" call vte_terminal_watch_child().
+void terminal_spawn(VteTerminal *terminal, char **argv, const char *workdir,
+                    VteTerminalSpawnAsyncCallback callback, gpointer user_data);
+// Connect a child already running on pty, e.g. a pooled shell
+void terminal_adopt_child(VteTerminal *terminal, VtePty *pty, GPid pid);
+// Our environment plus what vte_terminal_spawn_async() would have added
+char** terminal_child_environ();
+
+// Bold bracketed status line from mini-t itself, not the child
+void terminal_notice(VteTerminal *terminal, const std::string &text);
+
+// Tee the tab's output to a file under MINI_T_SESSION_LOG_DIR
+bool start_session_log(VteTerminal *terminal);
+void stop_session_log(VteTerminal *terminal);
+bool session_log_active(VteTerminal *terminal);
 extern bool splash_shown;
 extern GtkNotebook* global_notebook;
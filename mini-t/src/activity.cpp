@@ -0,0 +1,218 @@
+#include "activity.hpp"
+#include "config.hpp"
+#include "tab.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+struct ProcSample {
+    unsigned long long ticks = 0; // utime + stime, plus those of reaped children
+    long rss_pages = 0;
+    unsigned long long rchar = 0;
+    unsigned long long wchar = 0;
+    int processes = 0;
+    std::string comm;             // the group leader's, if it is still around
+};
+
+static guint activity_source = 0;
+
+bool tab_in_background(GtkWidget *page) {
+    return !gtk_widget_get_mapped(page);
+}
+
+static bool read_stat(const char *pid, GPid *pgrp, ProcSample *process) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%s/stat", pid);
+    char *contents = nullptr;
+    if (!g_file_get_contents(path, &contents, nullptr, nullptr)) return false;
+
+    char *open_paren = strchr(contents, '(');
+    char *close_paren = strrchr(contents, ')');
+    if (!open_paren || !close_paren) {
+        g_free(contents);
+        return false;
+    }
+    process->comm.assign(open_paren + 1, close_paren - open_paren - 1);
+
+    // Fields after comm start at 3 (state); pgrp is 5, utime/stime/cutime/cstime
+    // are 14-17 and rss is 24
+    int group = 0;
+    unsigned long long utime = 0, stime = 0;
+    long long cutime = 0, cstime = 0;
+    long rss = 0;
+    int parsed = std::sscanf(close_paren + 2,
+                             "%*c %*d %d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %lld %lld %*d %*d %*d %*d %*u %*u %ld",
+                             &group, &utime, &stime, &cutime, &cstime, &rss);
+    g_free(contents);
+    if (parsed != 6) return false;
+    *pgrp = group;
+    process->ticks = utime + stime + cutime + cstime;
+    process->rss_pages = rss;
+    return true;
+}
+
+// Like the CPU times, these include children the process has reaped
+static void read_io(const char *pid, ProcSample *process) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%s/io", pid);
+    char *contents = nullptr;
+    if (!g_file_get_contents(path, &contents, nullptr, nullptr)) return;
+    const char *r = strstr(contents, "rchar:");
+    const char *w = strstr(contents, "wchar:");
+    if (r) process->rchar = g_ascii_strtoull(r + 6, nullptr, 10);
+    if (w) process->wchar = g_ascii_strtoull(w + 6, nullptr, 10);
+    g_free(contents);
+}
+
+// One pass over /proc per tick, shared by all busy tabs, summing every member
+// of each foreground group: for a build the leader is make, and the compilers
+// doing the work are its children. Counting reaped children's time and I/O
+// keeps the sums from falling when a compiler exits.
+static void sample_groups(std::map<GPid, ProcSample> &groups) {
+    DIR *proc = opendir("/proc");
+    if (!proc) return;
+    while (struct dirent *entry = readdir(proc)) {
+        if (!g_ascii_isdigit(entry->d_name[0])) continue;
+
+        GPid pgrp;
+        ProcSample process;
+        if (!read_stat(entry->d_name, &pgrp, &process)) continue;
+        auto group = groups.find(pgrp);
+        if (group == groups.end()) continue;
+        // Only members of a tracked group get their I/O file opened
+        read_io(entry->d_name, &process);
+
+        ProcSample &sample = group->second;
+        sample.ticks += process.ticks;
+        sample.rss_pages += process.rss_pages;
+        sample.rchar += process.rchar;
+        sample.wchar += process.wchar;
+        sample.processes++;
+        if (atoi(entry->d_name) == pgrp || sample.comm.empty()) sample.comm = process.comm;
+    }
+    closedir(proc);
+}
+
+static void set_marker(Tab *tab, const char *text, const char *tooltip) {
+    if (!tab->marker) return;
+    gtk_label_set_text(GTK_LABEL(tab->marker), text);
+    gtk_widget_set_tooltip_text(tab->marker, tooltip);
+}
+
+static void set_busy(Tab *tab, bool busy) {
+    if (tab->busy == busy) return;
+    tab->busy = busy;
+    if (tab->spinner) {
+        gtk_widget_set_visible(tab->spinner, busy);
+        if (busy) gtk_spinner_start(GTK_SPINNER(tab->spinner));
+        else gtk_spinner_stop(GTK_SPINNER(tab->spinner));
+    }
+
+    // A job finishing where nobody is looking is worth flagging
+    if (!busy && tab_in_background(GTK_WIDGET(tab->terminal))) {
+        tab->unseen = true;
+        set_marker(tab, "✓", "Finished");
+    }
+}
+
+// The tab's foreground process group while it runs a job, else -1
+static GPid foreground_job(Tab *tab) {
+    if (tab->pid <= 0 || tab->exited || !tab->pty) {
+        set_busy(tab, false);
+        return -1;
+    }
+
+    GPid pgid = tcgetpgrp(vte_pty_get_fd(tab->pty));
+    if (pgid <= 0) pgid = tab->pid;
+    set_busy(tab, pgid != tab->pid || !tab->runs_shell);
+    return tab->busy ? pgid : -1;
+}
+
+static void report_job(Tab *tab, GPid pgid, const ProcSample &sample, gint64 now) {
+    if (pgid <= 0 || sample.processes == 0) {
+        tab->sampled_pgid = -1;
+        if (tab->spinner) gtk_widget_set_tooltip_text(tab->spinner, nullptr);
+        return;
+    }
+
+    // Rates need two samples of the same job
+    if (tab->sampled_pgid == pgid && now > tab->sampled_us) {
+        double seconds = (now - tab->sampled_us) / 1e6;
+        auto delta = [](unsigned long long current, unsigned long long previous) {
+            return current > previous ? (double)(current - previous) : 0.0;
+        };
+        double cpu = delta(sample.ticks, tab->sampled_ticks) * 100.0 / sysconf(_SC_CLK_TCK) / seconds;
+        double read_kbs = delta(sample.rchar, tab->sampled_rchar) / 1024.0 / seconds;
+        double write_kbs = delta(sample.wchar, tab->sampled_wchar) / 1024.0 / seconds;
+        double rss_mb = sample.rss_pages * (double)sysconf(_SC_PAGESIZE) / (1024 * 1024);
+
+        char *tooltip = g_strdup_printf("%s (%d, %d processes): CPU %.0f%%, RSS %.1f MB, read %.0f KB/s, write %.0f KB/s",
+                                        sample.comm.c_str(), (int)pgid, sample.processes,
+                                        cpu, rss_mb, read_kbs, write_kbs);
+        if (tab->spinner) gtk_widget_set_tooltip_text(tab->spinner, tooltip);
+        g_free(tooltip);
+    }
+
+    tab->sampled_pgid = pgid;
+    tab->sampled_us = now;
+    tab->sampled_ticks = sample.ticks;
+    tab->sampled_rchar = sample.rchar;
+    tab->sampled_wchar = sample.wchar;
+}
+
+static gboolean sample_tabs(gpointer) {
+    gint64 now = g_get_monotonic_time();
+    std::vector<std::pair<Tab*, GPid>> jobs;
+    std::map<GPid, ProcSample> groups;
+    for (Tab *tab : all_tabs()) {
+        GPid pgid = foreground_job(tab);
+        jobs.push_back({tab, pgid});
+        if (pgid > 0) groups[pgid];
+    }
+
+    // No busy tab, no /proc scan
+    if (!groups.empty()) sample_groups(groups);
+    for (auto &[tab, pgid] : jobs) report_job(tab, pgid, pgid > 0 ? groups[pgid] : ProcSample(), now);
+    return G_SOURCE_CONTINUE;
+}
+
+// Output in a background tab: flag it once, then ignore further changes
+static void on_contents_changed(VteTerminal *terminal, gpointer) {
+    if (!tab_in_background(GTK_WIDGET(terminal))) return;
+    Tab *tab = tab_for(terminal);
+    if (!tab || tab->unseen) return;
+    tab->unseen = true;
+    set_marker(tab, "•", "New output");
+}
+
+static void on_page_added(GtkNotebook*, GtkWidget *page, guint, gpointer) {
+    if (!VTE_IS_TERMINAL(page)) return;
+    g_signal_handlers_disconnect_by_func(page, (gpointer)on_contents_changed, nullptr);
+    g_signal_connect(page, "contents-changed", G_CALLBACK(on_contents_changed), nullptr);
+}
+
+static void on_switch_page(GtkNotebook*, GtkWidget *page, guint, gpointer) {
+    if (!VTE_IS_TERMINAL(page)) return;
+    Tab *tab = tab_for(VTE_TERMINAL(page));
+    if (!tab || !tab->unseen) return;
+    tab->unseen = false;
+    set_marker(tab, "", nullptr);
+}
+
+void activity_start(GtkNotebook *notebook) {
+    g_signal_connect(notebook, "page-added", G_CALLBACK(on_page_added), nullptr);
+    g_signal_connect(notebook, "switch-page", G_CALLBACK(on_switch_page), nullptr);
+
+    // Pages added before we were listening
+    for (gint i = 0; i < gtk_notebook_get_n_pages(notebook); i++)
+        on_page_added(notebook, gtk_notebook_get_nth_page(notebook, i), i, nullptr);
+
+    if (!activity_source)
+        activity_source = g_timeout_add(mini_t_config().activity_interval_ms, sample_tabs, nullptr);
+}
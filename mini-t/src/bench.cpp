@@ -0,0 +1,287 @@
+#include "bench.hpp"
+#include "terminal.hpp"
+#include "tab.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Results go to stdout as one tab-separated "bench" line for bench/run.sh:
+//   throughput: bench  throughput  <seconds>  <peak_rss_kb>
+//   latency:    bench  latency     <p50_ms>  <p90_ms>  <p99_ms>  <max_ms>  <peak_rss_kb>
+//   tabs:       bench  tabs        <count>  <seconds>  <rss_before_kb>  <rss_after_kb>
+//   background: bench  background  <tabs>  <seconds>  <cpu_seconds>
+struct BenchState {
+    VteTerminal *terminal;
+    bool latency;
+    gint64 started_us;
+    gint64 key_sent_us;
+    glong sent_column;  // cursor when the key went out; the echo moves it
+    glong sent_row;
+    bool awaiting_echo;
+    bool awaiting_paint;
+    int keys_left;
+    std::vector<double> samples_ms;
+};
+
+// MINI_T_BENCH_TABS: open and close that many shell tabs, a few at a time,
+// then compare RSS once every session is reaped with RSS after a warm-up
+static const int CHURN_WARMUP_TABS = 16;
+static const size_t CHURN_PARALLEL = 8;
+static const guint CHURN_POLL_MS = 10;
+
+struct ChurnState {
+    GtkNotebook *notebook;
+    int total;   // warm-up included
+    int opened;
+    std::vector<VteTerminal*> open;
+    long rss_before_kb;
+    gint64 started_us;
+};
+
+static BenchState bench;
+
+static ChurnState churn;
+
+// MINI_T_BENCH_BACKGROUND: run the MINI_T_BENCH command in that many tabs at
+// once, all hidden behind an idle visible tab, and report mini-t's own CPU
+// time (GTK thread and PTY relays) until the last one exits
+struct BackgroundState {
+    int tabs;
+    int running;
+    gint64 started_us;
+    double started_cpu;
+};
+
+static BackgroundState background;
+
+static bool env_set(const char *name) {
+    const char *value = g_getenv(name);
+    return value && *value;
+}
+
+bool bench_enabled() {
+    return env_set("MINI_T_BENCH") || env_set("MINI_T_BENCH_TABS");
+}
+
+static double cpu_seconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static long current_rss_kb() {
+    long pages = 0, resident = 0;
+    FILE *f = std::fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    std::fclose(f);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    std::sort(sorted.begin(), sorted.end());
+    size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+static void finish() {
+    if (bench.latency) {
+        std::printf("bench\tlatency\t%.3f\t%.3f\t%.3f\t%.3f\t%ld\n",
+                    percentile(bench.samples_ms, 0.50), percentile(bench.samples_ms, 0.90),
+                    percentile(bench.samples_ms, 0.99), percentile(bench.samples_ms, 1.0),
+                    peak_rss_kb());
+    } else {
+        std::printf("bench\tthroughput\t%.3f\t%ld\n",
+                    (g_get_monotonic_time() - bench.started_us) / 1e6, peak_rss_kb());
+    }
+    std::fflush(stdout);
+    g_application_quit(g_application_get_default());
+}
+
+static gboolean send_key(gpointer) {
+    vte_terminal_get_cursor_position(bench.terminal, &bench.sent_column, &bench.sent_row);
+    bench.key_sent_us = g_get_monotonic_time();
+    bench.awaiting_echo = true;
+    vte_terminal_feed_child(bench.terminal, "x", 1);
+    return G_SOURCE_REMOVE;
+}
+
+// Input-to-display latency ends when the first frame painted after the echo
+// was parsed is done; frames already queued before that don't count
+static void on_after_paint(GdkFrameClock*, gpointer) {
+    if (!bench.awaiting_paint || !bench.latency) return;
+    bench.awaiting_paint = false;
+    bench.samples_ms.push_back((g_get_monotonic_time() - bench.key_sent_us) / 1000.0);
+
+    if (--bench.keys_left > 0) g_idle_add(send_key, nullptr);
+    else vte_terminal_feed_child(bench.terminal, "q", 1); // tells the workload to exit
+}
+
+static void on_terminal_realize(GtkWidget *widget, gpointer) {
+    g_signal_connect(gtk_widget_get_frame_clock(widget), "after-paint", G_CALLBACK(on_after_paint), nullptr);
+}
+
+static void on_contents_changed(VteTerminal *terminal, gpointer) {
+    if (!bench.awaiting_echo) return;
+    glong column, row;
+    vte_terminal_get_cursor_position(terminal, &column, &row);
+    if (column == bench.sent_column && row == bench.sent_row) return;
+
+    bench.awaiting_echo = false;
+    bench.awaiting_paint = true;
+    gtk_widget_queue_draw(GTK_WIDGET(terminal));
+}
+
+// VTE emits child-exited only after draining the PTY, so all output has been parsed
+static void on_child_exited(VteTerminal*, gint status, gpointer) {
+    if (status != 0) g_printerr("mini-t: bench workload exited with status %d\n", status);
+    finish();
+}
+
+static gboolean start_keys(gpointer) {
+    send_key(nullptr);
+    return G_SOURCE_REMOVE;
+}
+
+static void on_workload_spawned(VteTerminal *terminal, GPid pid, GError *error, gpointer) {
+    if (error) {
+        g_printerr("mini-t: failed to start bench workload: %s\n", error->message);
+        g_application_quit(g_application_get_default());
+        return;
+    }
+    vte_terminal_watch_child(terminal, pid);
+    bench.started_us = g_get_monotonic_time();
+    // Give the echo workload time to put the PTY into raw mode
+    if (bench.latency) g_timeout_add(200, start_keys, nullptr);
+}
+
+static gboolean churn_tabs(gpointer) {
+    // Close each tab as soon as its shell is running
+    for (size_t i = 0; i < churn.open.size();) {
+        Tab *tab = tab_for(churn.open[i]);
+        if (tab && tab->pid > 0) {
+            tab_close(churn.notebook, churn.open[i]);
+            churn.open.erase(churn.open.begin() + i);
+        } else {
+            i++;
+        }
+    }
+
+    bool settled = churn.open.empty() && tab_reapers_pending() == 0;
+    if (churn.opened == CHURN_WARMUP_TABS && churn.rss_before_kb < 0) {
+        if (!settled) return G_SOURCE_CONTINUE;
+        malloc_trim(0);
+        churn.rss_before_kb = current_rss_kb();
+        churn.started_us = g_get_monotonic_time();
+    }
+
+    while (churn.open.size() < CHURN_PARALLEL && churn.opened < churn.total &&
+           (churn.opened != CHURN_WARMUP_TABS || churn.rss_before_kb >= 0)) {
+        VteTerminal *terminal = spawn_terminal(nullptr, false);
+        tab_add(churn.notebook, terminal, "churn");
+        churn.open.push_back(terminal);
+        churn.opened++;
+    }
+
+    if (churn.opened < churn.total || !settled) return G_SOURCE_CONTINUE;
+    malloc_trim(0);
+    std::printf("bench\ttabs\t%d\t%.3f\t%ld\t%ld\n", churn.total - CHURN_WARMUP_TABS,
+                (g_get_monotonic_time() - churn.started_us) / 1e6, churn.rss_before_kb, current_rss_kb());
+    std::fflush(stdout);
+    g_application_quit(g_application_get_default());
+    return G_SOURCE_REMOVE;
+}
+
+static void start_churn(GtkNotebook *notebook, int count) {
+    churn.notebook = notebook;
+    churn.total = CHURN_WARMUP_TABS + std::max(count, 1);
+    churn.opened = 0;
+    churn.rss_before_kb = -1;
+    gtk_widget_show_all(GTK_WIDGET(notebook));
+    g_timeout_add(CHURN_POLL_MS, churn_tabs, nullptr);
+}
+
+static void on_background_exited(VteTerminal*, gint status, gpointer) {
+    if (status != 0) g_printerr("mini-t: bench workload exited with status %d\n", status);
+    if (--background.running > 0) return;
+    std::printf("bench\tbackground\t%d\t%.3f\t%.3f\n", background.tabs,
+                (g_get_monotonic_time() - background.started_us) / 1e6, cpu_seconds() - background.started_cpu);
+    std::fflush(stdout);
+    g_application_quit(g_application_get_default());
+}
+
+static void on_background_spawned(VteTerminal *terminal, GPid pid, GError *error, gpointer) {
+    if (error) {
+        g_printerr("mini-t: failed to start bench workload: %s\n", error->message);
+        g_application_quit(g_application_get_default());
+        return;
+    }
+    vte_terminal_watch_child(terminal, pid);
+}
+
+static void start_background(GtkNotebook *notebook, char **argv, int count) {
+    background.tabs = background.running = std::max(count, 1);
+    background.started_us = g_get_monotonic_time();
+    background.started_cpu = cpu_seconds();
+    for (int i = 0; i < background.tabs; i++) {
+        VteTerminal *terminal = new_terminal(false);
+        tab_add(notebook, terminal, "background");
+        g_signal_connect(terminal, "child-exited", G_CALLBACK(on_background_exited), nullptr);
+        terminal_spawn(terminal, argv, nullptr, on_background_spawned, nullptr);
+    }
+
+    // Added last, so it is the page shown and every workload runs hidden
+    tab_add(notebook, new_terminal(false), "idle");
+    gtk_widget_show_all(GTK_WIDGET(notebook));
+}
+
+void bench_start(GtkNotebook *notebook) {
+    if (env_set("MINI_T_BENCH_TABS")) {
+        start_churn(notebook, atoi(g_getenv("MINI_T_BENCH_TABS")));
+        return;
+    }
+
+    const char *command = g_getenv("MINI_T_BENCH");
+    char **argv = nullptr;
+    GError *error = nullptr;
+    if (!g_shell_parse_argv(command, nullptr, &argv, &error)) {
+        g_printerr("mini-t: bad MINI_T_BENCH command: %s\n", error->message);
+        g_error_free(error);
+        g_application_quit(g_application_get_default());
+        return;
+    }
+
+    if (env_set("MINI_T_BENCH_BACKGROUND")) {
+        start_background(notebook, argv, atoi(g_getenv("MINI_T_BENCH_BACKGROUND")));
+        g_strfreev(argv);
+        return;
+    }
+
+    const char *samples = g_getenv("MINI_T_BENCH_LATENCY_SAMPLES");
+    bench.latency = samples && *samples;
+    bench.keys_left = bench.latency ? atoi(samples) : 0;
+    bench.terminal = new_terminal(false);
+
+    gtk_notebook_append_page(notebook, GTK_WIDGET(bench.terminal), gtk_label_new("Benchmark"));
+    gtk_widget_show_all(GTK_WIDGET(notebook));
+
+    g_signal_connect(bench.terminal, "contents-changed", G_CALLBACK(on_contents_changed), nullptr);
+    g_signal_connect(bench.terminal, "child-exited", G_CALLBACK(on_child_exited), nullptr);
+    g_signal_connect(bench.terminal, "realize", G_CALLBACK(on_terminal_realize), nullptr);
+
+    // Through the same PTY relay as any tab, so its cost is part of the numbers
+    terminal_spawn(bench.terminal, argv, nullptr, on_workload_spawned, nullptr);
+    g_strfreev(argv);
+}
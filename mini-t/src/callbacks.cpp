@@ -1,26 +1,26 @@
 #include "callbacks.hpp"
 #include "terminal.hpp"
-#include <fstream>
+#include "script.hpp"
+#include "shell_pool.hpp"
+#include "bench.hpp"
+#include "search.hpp"
+#include "tab.hpp"
+#include "activity.hpp"
+#include "session_log.hpp"
 #include <string>
 #include <iostream>
 
 // New tab
 void on_new_tab(GtkNotebook* notebook) {
     VteTerminal *term = spawn_terminal(GTK_WIDGET(notebook));
+    tab_add(notebook, term, "Terminal");
+}
 
-    GtkWidget *label_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 4);
-    GtkWidget *label = gtk_label_new("Terminal");
-    GtkWidget *close_btn = gtk_button_new_from_icon_name("window-close-symbolic", GTK_ICON_SIZE_MENU);
-    gtk_widget_set_can_focus(close_btn, FALSE);
-
-    gtk_box_pack_start(GTK_BOX(label_box), label, TRUE, TRUE, 0);
-    gtk_box_pack_start(GTK_BOX(label_box), close_btn, FALSE, FALSE, 0);
-
-    gtk_notebook_append_page(notebook, GTK_WIDGET(term), label_box);
-    gtk_notebook_set_tab_reorderable(notebook, GTK_WIDGET(term), TRUE);
-    gtk_notebook_set_current_page(notebook, gtk_notebook_get_n_pages(notebook)-1);
-
-    g_signal_connect_swapped(close_btn, "clicked", G_CALLBACK(gtk_notebook_remove_page), notebook);
+void on_new_tab_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    (void)action;    // unused
+    (void)parameter; // unused
+    (void)user_data; // unused
+    on_new_tab(global_notebook);
 }
 
 // File dialog response
@@ -35,29 +35,10 @@ void on_file_dialog_response(GtkDialog *dialog, gint response_id, gpointer user_
     char *filename = gtk_file_chooser_get_filename(chooser);
     if (!filename) { gtk_widget_destroy(GTK_WIDGET(dialog)); return; }
 
-    std::ifstream filestream(filename);
-    if (!filestream.is_open()) { g_free(filename); gtk_widget_destroy(GTK_WIDGET(dialog)); return; }
-
-    std::string command((std::istreambuf_iterator<char>(filestream)), std::istreambuf_iterator<char>());
-    filestream.close();
-
-    VteTerminal *term = spawn_terminal(GTK_WIDGET(notebook));
-    vte_terminal_feed(term, command.c_str(), command.size());
-
-    GtkWidget *label_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 4);
+    VteTerminal *term = new_terminal(false);
     char *basename = g_path_get_basename(filename);
-    GtkWidget *label = gtk_label_new(basename);
-    GtkWidget *close_btn = gtk_button_new_from_icon_name("window-close-symbolic", GTK_ICON_SIZE_MENU);
-    gtk_widget_set_can_focus(close_btn, FALSE);
-
-    gtk_box_pack_start(GTK_BOX(label_box), label, TRUE, TRUE, 0);
-    gtk_box_pack_start(GTK_BOX(label_box), close_btn, FALSE, FALSE, 0);
-
-    gtk_notebook_append_page(notebook, GTK_WIDGET(term), label_box);
-    gtk_notebook_set_tab_reorderable(notebook, GTK_WIDGET(term), TRUE);
-    gtk_notebook_set_current_page(notebook, gtk_notebook_get_n_pages(notebook)-1);
-
-    g_signal_connect_swapped(close_btn, "clicked", G_CALLBACK(gtk_notebook_remove_page), notebook);
+    tab_add(notebook, term, basename);
+    run_script(term, filename);
 
     g_free(filename);
     g_free(basename);
@@ -81,6 +62,20 @@ void on_open_script(GSimpleAction *action, GVariant *parameter, gpointer user_da
     gtk_widget_show(dialog);
 }
 
+// Start or stop logging the current tab
+void on_toggle_session_log(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    (void)action;    // unused
+    (void)parameter; // unused
+    (void)user_data; // unused
+
+    gint page = gtk_notebook_get_current_page(global_notebook);
+    if (page < 0) return;
+    VteTerminal *term = VTE_TERMINAL(gtk_notebook_get_nth_page(global_notebook, page));
+
+    if (session_log_active(term)) stop_session_log(term);
+    else start_session_log(term);
+}
+
 // About dialog
 void on_about(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
     (void)action;    // unused
@@ -113,6 +108,11 @@ void on_activate(GtkApplication *app, gpointer user_data) {
     GMenu *file_menu = g_menu_new();
     g_menu_append(file_menu, "New Tab", "app.new_tab");
     g_menu_append(file_menu, "Open Script", "app.open_script");
+    g_menu_append(file_menu, "Search Tabs", "app.search_tabs");
+    g_menu_append(file_menu, "Log Session", "app.toggle_session_log");
+
+    const char *search_accels[] = { "<Primary><Shift>f", nullptr };
+    gtk_application_set_accels_for_action(app, "app.search_tabs", search_accels);
 
     GtkWidget *file_button = gtk_menu_button_new();
     gtk_menu_button_set_menu_model(GTK_MENU_BUTTON(file_button), G_MENU_MODEL(file_menu));
@@ -123,6 +123,7 @@ void on_activate(GtkApplication *app, gpointer user_data) {
 
     // Help menu
     GMenu *help_menu = g_menu_new();
+    g_menu_append(help_menu, "Diagnostics", "app.diagnostics");
     g_menu_append(help_menu, "About", "app.about");
 
     GtkWidget *help_button = gtk_menu_button_new();
@@ -137,9 +138,25 @@ void on_activate(GtkApplication *app, gpointer user_data) {
     gtk_widget_set_hexpand(notebook, TRUE);
     gtk_widget_set_vexpand(notebook, TRUE);
     gtk_container_add(GTK_CONTAINER(window), notebook);
+    gtk_widget_show(notebook);
 
     global_notebook = GTK_NOTEBOOK(notebook);
+    if (bench_enabled()) {
+        bench_start(GTK_NOTEBOOK(notebook));
+        gtk_widget_show(window);
+        return;
+    }
     on_new_tab(GTK_NOTEBOOK(notebook));
 
     gtk_widget_show(window);
+    shell_pool_start();
+    activity_start(GTK_NOTEBOOK(notebook));
+}
+
+// Shutdown application
+void on_shutdown(GApplication *app, gpointer user_data) {
+    (void)app;       // unused
+    (void)user_data; // unused
+    shell_pool_shutdown();
+    session_log_shutdown();
 }
@@ -0,0 +1,48 @@
+#include "config.hpp"
+
+static glong env_long(const char *name, glong fallback, glong min_value) {
+    const char *value = g_getenv(name);
+    if (!value || !*value) return fallback;
+    if (min_value < 0 && g_ascii_strcasecmp(value, "unlimited") == 0) return -1;
+
+    char *end = nullptr;
+    gint64 parsed = g_ascii_strtoll(value, &end, 10);
+    if (*end != '\0' || parsed < min_value) {
+        g_printerr("mini-t: ignoring invalid %s=%s\n", name, value);
+        return fallback;
+    }
+    return (glong)parsed;
+}
+
+static bool env_bool(const char *name, bool fallback) {
+    const char *value = g_getenv(name);
+    if (!value || !*value) return fallback;
+    return g_strcmp0(value, "0") != 0 && g_ascii_strcasecmp(value, "false") != 0;
+}
+
+static std::string env_string(const char *name, const std::string &fallback) {
+    const char *value = g_getenv(name);
+    return value && *value ? value : fallback;
+}
+
+const MiniTConfig& mini_t_config() {
+    static const MiniTConfig config = [] {
+        MiniTConfig c;
+        c.scrollback_lines = env_long("MINI_T_SCROLLBACK", 100000, -1);
+        c.search_index_bytes = (size_t)env_long("MINI_T_SEARCH_INDEX_MB", 4, 1) * 1024 * 1024;
+        c.shell_pool_size = env_long("MINI_T_SHELL_POOL", 2, 0);
+        c.shell_pool_refill_ms = env_long("MINI_T_SHELL_POOL_REFILL_MS", 250, 0);
+
+        char *log_dir = g_build_filename(g_get_user_state_dir(), "mini-t", "logs", NULL);
+        c.session_log_all = env_bool("MINI_T_SESSION_LOG", false);
+        c.session_log_dir = env_string("MINI_T_SESSION_LOG_DIR", log_dir);
+        c.session_log_compress = env_bool("MINI_T_SESSION_LOG_COMPRESS", false);
+        c.session_log_timestamps = env_bool("MINI_T_SESSION_LOG_TIMESTAMPS", false);
+        g_free(log_dir);
+
+        c.activity_interval_ms = env_long("MINI_T_ACTIVITY_INTERVAL_MS", 1000, 100);
+        c.background_throttle = env_bool("MINI_T_BACKGROUND_THROTTLE", true);
+        return c;
+    }();
+    return config;
+}
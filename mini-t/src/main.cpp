@@ -1,23 +1,44 @@
 #include "callbacks.hpp"
+#include "search.hpp"
+#include "bench.hpp"
+#include "tab.hpp"
+#include "trace.hpp"
 #include <gtk/gtk.h>
 
 int main(int argc, char *argv[]) {
-    GtkApplication *app = gtk_application_new("com.example.mini-t", G_APPLICATION_DEFAULT_FLAGS);
+    trace::init("mini-t");
+
+    // Benchmark runs must not hand off to an already running instance
+    GApplicationFlags flags = bench_enabled() ? G_APPLICATION_NON_UNIQUE : G_APPLICATION_DEFAULT_FLAGS;
+    GtkApplication *app = gtk_application_new("com.example.mini-t", flags);
 
     // Actions
     GSimpleAction *new_tab_action = g_simple_action_new("new_tab", nullptr);
-    g_signal_connect(new_tab_action, "activate", G_CALLBACK(on_new_tab), nullptr);
+    g_signal_connect(new_tab_action, "activate", G_CALLBACK(on_new_tab_action), nullptr);
     g_action_map_add_action(G_ACTION_MAP(app), G_ACTION(new_tab_action));
 
     GSimpleAction *open_script_action = g_simple_action_new("open_script", nullptr);
     g_signal_connect(open_script_action, "activate", G_CALLBACK(on_open_script), app);
     g_action_map_add_action(G_ACTION_MAP(app), G_ACTION(open_script_action));
 
+    GSimpleAction *search_tabs_action = g_simple_action_new("search_tabs", nullptr);
+    g_signal_connect(search_tabs_action, "activate", G_CALLBACK(on_search_tabs), app);
+    g_action_map_add_action(G_ACTION_MAP(app), G_ACTION(search_tabs_action));
+
+    GSimpleAction *session_log_action = g_simple_action_new("toggle_session_log", nullptr);
+    g_signal_connect(session_log_action, "activate", G_CALLBACK(on_toggle_session_log), app);
+    g_action_map_add_action(G_ACTION_MAP(app), G_ACTION(session_log_action));
+
+    GSimpleAction *diagnostics_action = g_simple_action_new("diagnostics", nullptr);
+    g_signal_connect(diagnostics_action, "activate", G_CALLBACK(on_diagnostics), app);
+    g_action_map_add_action(G_ACTION_MAP(app), G_ACTION(diagnostics_action));
+
     GSimpleAction *about_action = g_simple_action_new("about", nullptr);
     g_signal_connect(about_action, "activate", G_CALLBACK(on_about), app);
     g_action_map_add_action(G_ACTION_MAP(app), G_ACTION(about_action));
 
     g_signal_connect(app, "activate", G_CALLBACK(on_activate), nullptr);
+    g_signal_connect(app, "shutdown", G_CALLBACK(on_shutdown), nullptr);
 
     int status = g_application_run(G_APPLICATION(app), argc, argv);
     g_object_unref(app);
@@ -0,0 +1,227 @@
+#include "pty_relay.hpp"
+#include "session_log.hpp"
+#include "trace.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const size_t RELAY_CHUNK = 64 * 1024;
+
+struct PtyRelay {
+    int child_fd;      // the child's PTY master (a dup), non-blocking
+    int term_fd;       // slave side of the terminal's PTY, in raw mode
+    int wake_fd;       // eventfd: the log changed or the terminal went away
+    VteTerminal *terminal; // GTK thread only: window size changes
+    VtePty *child_pty;
+    glong rows = 0, columns = 0;
+    std::atomic<int> refs{2}; // the GTK side and the relay thread
+
+    // log is the one the GTK thread set last; the relay thread picks it up on
+    // wake_fd and closes the one it was writing to
+    std::mutex mutex;
+    SessionLog *log = nullptr;
+    bool released = false;
+    bool finished = false; // the relay thread has stopped writing to log
+};
+
+static void unref(PtyRelay *relay) {
+    if (--relay->refs > 0) return;
+    close(relay->wake_fd);
+    delete relay;
+}
+
+static bool write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// read() that tells "nothing yet" (0) apart from "the other side is gone" (-1)
+static ssize_t read_some(int fd, char *buf, size_t len) {
+    ssize_t n = read(fd, buf, len);
+    if (n > 0) return n;
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+    return -1; // EOF, or EIO once every descriptor on the other end is closed
+}
+
+static void relay_main(PtyRelay *relay) {
+    std::vector<char> buf(RELAY_CHUNK);
+    std::string input; // keystrokes the child's PTY hasn't taken yet
+    SessionLog *active = nullptr;
+
+    for (;;) {
+        struct pollfd fds[3] = {
+            {relay->child_fd, (short)(POLLIN | (input.empty() ? 0 : POLLOUT)), 0},
+            {relay->term_fd, POLLIN, 0},
+            {relay->wake_fd, POLLIN, 0},
+        };
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[2].revents & POLLIN) {
+            uint64_t count;
+            if (read(relay->wake_fd, &count, sizeof(count)) < 0) {} // only clears the eventfd
+            std::lock_guard<std::mutex> lock(relay->mutex);
+            if (active != relay->log) {
+                if (active) session_log_close(active);
+                active = relay->log;
+            }
+            if (relay->released) break;
+        }
+
+        // Output goes to the log before the terminal sees it, so whatever the
+        // terminal shows is already on its way to disk
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            TRACE_SCOPE("pty relay output");
+            ssize_t n = read_some(relay->child_fd, buf.data(), buf.size());
+            if (n < 0) break;
+            if (active) session_log_write(active, buf.data(), n);
+            if (!write_all(relay->term_fd, buf.data(), n)) break;
+        }
+
+        if (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t n = read_some(relay->term_fd, buf.data(), buf.size());
+            if (n < 0) break;
+            input.append(buf.data(), n);
+        }
+
+        if (!input.empty() && (fds[0].revents & POLLOUT)) {
+            ssize_t n = write(relay->child_fd, input.data(), input.size());
+            if (n > 0) input.erase(0, n);
+            else if (n < 0 && errno != EAGAIN && errno != EINTR) break;
+        }
+    }
+
+    // Closing the terminal's slave is what lets VTE see end of file
+    close(relay->term_fd);
+    close(relay->child_fd);
+
+    {
+        std::lock_guard<std::mutex> lock(relay->mutex);
+        if (active && active != relay->log) session_log_close(active);
+        // A log the GTK thread still holds stays open, idle, until it lets go
+        if (relay->released && relay->log) session_log_close(relay->log);
+        relay->finished = true;
+    }
+    unref(relay);
+}
+
+static void sync_size(VteTerminal *terminal, PtyRelay *relay) {
+    glong rows = vte_terminal_get_row_count(terminal);
+    glong columns = vte_terminal_get_column_count(terminal);
+    if (rows == relay->rows && columns == relay->columns) return;
+    relay->rows = rows;
+    relay->columns = columns;
+    // The kernel sends the child's foreground job SIGWINCH
+    vte_pty_set_size(relay->child_pty, rows, columns, nullptr);
+}
+
+static void on_size_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer user_data) {
+    (void)allocation; // unused
+    sync_size(VTE_TERMINAL(widget), (PtyRelay*)user_data);
+}
+
+static int open_slave(int master) {
+#ifdef TIOCGPTPEER
+    int fd = ioctl(master, TIOCGPTPEER, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd >= 0) return fd;
+#endif
+    const char *name = ptsname(master);
+    return name ? open(name, O_RDWR | O_NOCTTY | O_CLOEXEC) : -1;
+}
+
+PtyRelay* pty_relay_attach(VteTerminal *terminal, VtePty *child_pty) {
+    GError *error = nullptr;
+    VtePty *term_pty = vte_pty_new_sync(VTE_PTY_DEFAULT, nullptr, &error);
+    if (!term_pty) {
+        g_printerr("mini-t: failed to open relay PTY: %s\n", error->message);
+        g_error_free(error);
+        return nullptr;
+    }
+
+    int term_fd = open_slave(vte_pty_get_fd(term_pty));
+    int child_fd = fcntl(vte_pty_get_fd(child_pty), F_DUPFD_CLOEXEC, 0);
+    int wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (term_fd < 0 || child_fd < 0 || wake_fd < 0) {
+        g_printerr("mini-t: failed to set up PTY relay: %s\n", g_strerror(errno));
+        if (term_fd >= 0) close(term_fd);
+        if (child_fd >= 0) close(child_fd);
+        if (wake_fd >= 0) close(wake_fd);
+        g_object_unref(term_pty);
+        return nullptr;
+    }
+
+    // The child's PTY does all line discipline; this one passes bytes through
+    struct termios tio;
+    if (tcgetattr(term_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(term_fd, TCSANOW, &tio);
+    }
+    fcntl(child_fd, F_SETFL, fcntl(child_fd, F_GETFL) | O_NONBLOCK);
+
+    PtyRelay *relay = new PtyRelay();
+    relay->child_fd = child_fd;
+    relay->term_fd = term_fd;
+    relay->wake_fd = wake_fd;
+    relay->terminal = terminal;
+    relay->child_pty = VTE_PTY(g_object_ref(child_pty));
+
+    vte_terminal_set_pty(terminal, term_pty);
+    g_object_unref(term_pty);
+    sync_size(terminal, relay);
+    g_signal_connect(terminal, "size-allocate", G_CALLBACK(on_size_allocate), relay);
+
+    std::thread(relay_main, relay).detach();
+    return relay;
+}
+
+static void wake(PtyRelay *relay) {
+    uint64_t one = 1;
+    if (write(relay->wake_fd, &one, sizeof(one)) < 0) {} // already pending
+}
+
+void pty_relay_release(PtyRelay *relay) {
+    g_signal_handlers_disconnect_by_data(relay->terminal, relay);
+    g_object_unref(relay->child_pty);
+    relay->child_pty = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(relay->mutex);
+        relay->released = true;
+        if (relay->finished && relay->log) session_log_close(relay->log);
+        if (!relay->finished) wake(relay);
+    }
+    unref(relay);
+}
+
+void pty_relay_set_log(PtyRelay *relay, SessionLog *log) {
+    std::lock_guard<std::mutex> lock(relay->mutex);
+    if (log == relay->log) return;
+    // Once the thread is done nobody writes to the log, so it can go here
+    if (relay->finished && relay->log) session_log_close(relay->log);
+    relay->log = log;
+    if (!relay->finished) wake(relay);
+}
+
+SessionLog* pty_relay_log(const PtyRelay *relay) {
+    return relay->log;
+}
@@ -0,0 +1,190 @@
+#include "script.hpp"
+#include "terminal.hpp"
+#include "tab.hpp"
+#include <glib-unix.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Only this much of the file is read for a "#!" line, like the kernel's binprm buffer
+static const size_t SHEBANG_BYTES = 256;
+// Without pidfd_open() (Linux < 5.3) the script is polled for instead
+static const guint REAP_POLL_MS = 100;
+
+// The script is reaped here rather than by VTE, so wait4() can hand over its
+// own resource usage. The report waits for both the exit and VTE's end of
+// file, so it comes after the script's last output.
+struct ScriptRun {
+    VteTerminal *terminal;
+    GPid pid;
+    gint64 started_us;
+    gint64 ended_us;
+    int pidfd;
+    guint watch_source;
+    bool reaped;
+    bool drained;
+    int status;
+    struct rusage usage; // the script and the descendants it waited for
+};
+
+static double timeval_seconds(const struct timeval &tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// Executables run directly; the kernel handles their "#!" line and GLib retries
+// ones it refuses with /bin/sh. Otherwise the interpreter comes from the "#!"
+// line, else from the extension, else /bin/sh.
+static std::vector<std::string> script_argv(const char *path) {
+    std::vector<std::string> argv;
+    if (g_file_test(path, G_FILE_TEST_IS_REGULAR) && access(path, X_OK) == 0) {
+        argv.push_back(path);
+        return argv;
+    }
+
+    char head[SHEBANG_BYTES];
+    std::ifstream file(path, std::ios::binary);
+    file.read(head, sizeof(head));
+    std::string first_line(head, file.gcount());
+    first_line = first_line.substr(0, first_line.find('\n'));
+    if (first_line.compare(0, 2, "#!") == 0) {
+        // Like the kernel: interpreter, then everything after it as one argument
+        std::string rest = first_line.substr(2);
+        size_t begin = rest.find_first_not_of(" \t");
+        size_t end = rest.find_last_not_of(" \t\r");
+        if (begin != std::string::npos) {
+            rest = rest.substr(begin, end - begin + 1);
+            size_t space = rest.find_first_of(" \t");
+            argv.push_back(rest.substr(0, space));
+            if (space != std::string::npos) {
+                size_t arg = rest.find_first_not_of(" \t", space);
+                argv.push_back(rest.substr(arg));
+            }
+        }
+    }
+
+    if (argv.empty()) {
+        std::string name = path;
+        auto ends_with = [&](const char *ext) {
+            std::string e = ext;
+            return name.size() >= e.size() && name.compare(name.size() - e.size(), e.size(), e) == 0;
+        };
+        if (ends_with(".py")) argv.push_back("python3");
+        else if (ends_with(".pl")) argv.push_back("perl");
+        else if (ends_with(".rb")) argv.push_back("ruby");
+        else if (ends_with(".js")) argv.push_back("node");
+        else if (ends_with(".bash")) argv.push_back("bash");
+        else argv.push_back("/bin/sh");
+    }
+
+    argv.push_back(path);
+    return argv;
+}
+
+static void report_script(ScriptRun *run) {
+    if (!run->reaped || !run->drained) return;
+    double wall = (run->ended_us - run->started_us) / 1e6;
+    double user = timeval_seconds(run->usage.ru_utime);
+    double sys = timeval_seconds(run->usage.ru_stime);
+
+    int status = run->status;
+    char *result;
+    if (WIFEXITED(status)) result = g_strdup_printf("exited with status %d", WEXITSTATUS(status));
+    else if (WIFSIGNALED(status)) result = g_strdup_printf("killed by signal %d (%s)", WTERMSIG(status), g_strsignal(WTERMSIG(status)));
+    else result = g_strdup_printf("ended with wait status %d", status);
+
+    char *notice = g_strdup_printf("script %s — wall %.2f s, CPU %.2f s (user %.2f + sys %.2f)",
+                                   result, wall, user + sys, user, sys);
+    terminal_notice(run->terminal, notice);
+    g_free(notice);
+    g_free(result);
+}
+
+// Returns whether the script is gone, reaped here or (ECHILD) by someone else
+static bool reap_script(ScriptRun *run) {
+    int status = 0;
+    pid_t pid = wait4(run->pid, &status, WNOHANG, &run->usage);
+    if (pid == 0 || (pid < 0 && errno == EINTR)) return false;
+    if (pid < 0) memset(&run->usage, 0, sizeof(run->usage));
+
+    run->reaped = true;
+    run->status = status;
+    run->ended_us = g_get_monotonic_time();
+    run->watch_source = 0;
+    tab_set_exited(run->terminal, status);
+    report_script(run);
+    return true;
+}
+
+static gboolean on_script_pidfd(gint fd, GIOCondition condition, gpointer user_data) {
+    (void)fd;        // unused
+    (void)condition; // unused
+    return reap_script((ScriptRun*)user_data) ? G_SOURCE_REMOVE : G_SOURCE_CONTINUE;
+}
+
+static gboolean poll_script(gpointer user_data) {
+    return reap_script((ScriptRun*)user_data) ? G_SOURCE_REMOVE : G_SOURCE_CONTINUE;
+}
+
+static void on_script_spawned(VteTerminal *terminal, GPid pid, GError *error, gpointer user_data) {
+    ScriptRun *run = (ScriptRun*)user_data;
+    if (error) {
+        terminal_notice(terminal, std::string("failed to start script: ") + error->message);
+        return;
+    }
+    run->pid = pid;
+#ifdef SYS_pidfd_open
+    run->pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+#endif
+    if (run->pidfd >= 0) run->watch_source = g_unix_fd_add(run->pidfd, G_IO_IN, on_script_pidfd, run);
+    else run->watch_source = g_timeout_add(REAP_POLL_MS, poll_script, run);
+}
+
+static void on_script_eof(VteTerminal *terminal, gpointer user_data) {
+    (void)terminal; // unused
+    ScriptRun *run = (ScriptRun*)user_data;
+    run->drained = true;
+    report_script(run);
+}
+
+// A script still running is left to tab_close(), which hangs up and reaps it
+static void on_script_destroy(GtkWidget *widget, gpointer user_data) {
+    (void)widget; // unused
+    ScriptRun *run = (ScriptRun*)user_data;
+    if (run->watch_source) g_source_remove(run->watch_source);
+    if (run->pidfd >= 0) close(run->pidfd);
+    delete run;
+}
+
+// The child writes to its PTY and the relay passes output on as it comes, so
+// the kernel's PTY buffer gives backpressure and VTE renders as it streams in.
+void run_script(VteTerminal *terminal, const char *path) {
+    std::vector<std::string> args = script_argv(path);
+    std::vector<char*> argv;
+    for (std::string &arg : args) argv.push_back((char*)arg.c_str());
+    argv.push_back(nullptr);
+
+    Tab *tab = tab_for(terminal);
+    if (tab) tab->runs_shell = false;
+
+    char *workdir = g_path_get_dirname(path);
+    ScriptRun *run = new ScriptRun();
+    run->terminal = terminal;
+    run->pid = -1;
+    run->started_us = run->ended_us = g_get_monotonic_time();
+    run->pidfd = -1;
+    run->watch_source = 0;
+    run->reaped = run->drained = false;
+    run->status = 0;
+
+    g_signal_connect(terminal, "eof", G_CALLBACK(on_script_eof), run);
+    g_signal_connect(terminal, "destroy", G_CALLBACK(on_script_destroy), run);
+
+    terminal_spawn(terminal, argv.data(), workdir, on_script_spawned, run);
+    g_free(workdir);
+}
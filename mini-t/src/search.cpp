@@ -0,0 +1,575 @@
+#include "search.hpp"
+#include "terminal.hpp"
+#include "tab.hpp"
+#include "activity.hpp"
+#include "config.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// Rows are copied out of VTE on a timer rather than from "contents-changed"
+// itself, so heavy output only pays for setting a flag.
+static const guint INDEX_INTERVAL_MS = 100;
+static const guint BACKGROUND_INDEX_INTERVAL_MS = 1000;
+static const glong INDEX_ROWS_PER_TICK = 2048;
+static const glong BACKGROUND_INDEX_ROWS_PER_TICK = 8192;
+static const size_t MAX_RESULTS = 1000;
+// Indexed rows checked against VTE when the cursor moves back above them
+static const glong VERIFY_ROWS = 8;
+// Rows are sealed into compressed blocks of about this much text
+static const size_t BLOCK_BYTES = 64 * 1024;
+static const size_t TRIGRAM_BITS = 32768;
+
+// Older rows, compressed. trigrams has a bit set for every (lowercased)
+// three-byte sequence in the block, so literal searches skip blocks that
+// can't contain the query without inflating them.
+struct IndexBlock {
+    glong first_row;
+    glong rows;
+    size_t text_bytes;
+    std::vector<unsigned char> compressed;
+    std::bitset<TRIGRAM_BITS> trigrams;
+};
+
+struct ScrollbackIndex {
+    guint tab_id;
+    VteTerminal *terminal;
+    std::deque<IndexBlock> blocks;   // sealed rows, oldest first, ending at first_row
+    size_t block_bytes;              // compressed size of blocks
+    std::string text;                // the most recent rows, each terminated by '\n'
+    std::vector<size_t> line_starts; // offset of each row in text
+    glong first_row;                 // absolute VTE row of line_starts[0]
+    glong next_row;                  // first row not indexed yet
+    glong lower;                     // VTE's oldest row at the last pass
+    glong columns;                   // width the rows were wrapped at
+    bool paused;                     // the alternate screen is up; the index waits for the normal one
+    guint source_id;
+};
+
+struct SearchHit {
+    guint tab_id;
+    glong row;
+    std::string line;
+};
+
+enum { RES_TAB, RES_ROW, RES_LINE, RES_TAB_ID, RES_N_COLUMNS };
+
+static std::vector<ScrollbackIndex*> indexes;
+
+static GtkWidget *search_window = nullptr;
+static GtkWidget *search_entry;
+static GtkWidget *regex_check;
+static GtkWidget *case_check;
+static GtkWidget *status_label;
+static GtkListStore *results;
+
+static void run_search();
+
+// -------------------- Indexing --------------------
+static char* row_text(VteTerminal *terminal, glong row) {
+#if VTE_CHECK_VERSION(0, 72, 0)
+    return vte_terminal_get_text_range_format(terminal, VTE_FORMAT_TEXT, row, 0, row + 1, 0, nullptr);
+#else
+    return vte_terminal_get_text_range(terminal, row, 0, row,
+                                       vte_terminal_get_column_count(terminal) - 1,
+                                       nullptr, nullptr, nullptr);
+#endif
+}
+
+static size_t index_bytes(const ScrollbackIndex *idx) {
+    return idx->block_bytes + idx->blocks.size() * sizeof(IndexBlock)
+         + idx->text.size() + idx->line_starts.size() * sizeof(size_t);
+}
+
+static glong oldest_indexed_row(const ScrollbackIndex *idx) {
+    return idx->blocks.empty() ? idx->first_row : idx->blocks.front().first_row;
+}
+
+static bool index_empty(const ScrollbackIndex *idx) {
+    return idx->blocks.empty() && idx->line_starts.empty();
+}
+
+static size_t trigram_bit(unsigned char a, unsigned char b, unsigned char c) {
+    uint32_t t = (uint32_t)g_ascii_tolower(a) | (uint32_t)g_ascii_tolower(b) << 8 | (uint32_t)g_ascii_tolower(c) << 16;
+    return (t * 2654435761u) >> 17; // top 15 bits: TRIGRAM_BITS
+}
+
+static bool may_contain(const IndexBlock &block, const std::string &literal) {
+    for (size_t i = 0; i + 2 < literal.size(); i++)
+        if (!block.trigrams[trigram_bit(literal[i], literal[i + 1], literal[i + 2])]) return false;
+    return true;
+}
+
+static void drop_oldest_block(ScrollbackIndex *idx) {
+    idx->block_bytes -= idx->blocks.front().compressed.size();
+    idx->blocks.pop_front();
+}
+
+static void drop_oldest_rows(ScrollbackIndex *idx, size_t drop) {
+    size_t bytes = drop == idx->line_starts.size() ? idx->text.size() : idx->line_starts[drop];
+    idx->text.erase(0, bytes);
+    idx->line_starts.erase(idx->line_starts.begin(), idx->line_starts.begin() + drop);
+    for (size_t &start : idx->line_starts) start -= bytes;
+    idx->first_row += drop;
+}
+
+// Move all but the last few rows of a full tail into a compressed block;
+// those stay plain for first_stale_row() and truncate_index()
+static void seal_rows(ScrollbackIndex *idx) {
+    if (idx->text.size() < BLOCK_BYTES || idx->line_starts.size() <= (size_t)VERIFY_ROWS) return;
+    TRACE_SCOPE("seal index block");
+    size_t lines = idx->line_starts.size() - VERIFY_ROWS;
+    size_t bytes = idx->line_starts[lines];
+
+    IndexBlock block;
+    block.first_row = idx->first_row;
+    block.rows = lines;
+    block.text_bytes = bytes;
+    uLongf size = compressBound(bytes);
+    block.compressed.resize(size);
+    if (compress2(block.compressed.data(), &size, (const Bytef*)idx->text.data(), bytes, 1) != Z_OK) return;
+    block.compressed.resize(size);
+    block.compressed.shrink_to_fit();
+    const unsigned char *text = (const unsigned char*)idx->text.data();
+    for (size_t i = 0; i + 2 < bytes; i++) block.trigrams.set(trigram_bit(text[i], text[i + 1], text[i + 2]));
+
+    idx->block_bytes += size;
+    idx->blocks.push_back(std::move(block));
+    drop_oldest_rows(idx, lines);
+}
+
+// Drop rows VTE has already discarded from its scrollback, and the oldest rows
+// beyond the byte cap; scrollback may be unlimited but the index never is
+static void prune_index(ScrollbackIndex *idx, glong oldest_row) {
+    // Blocks go whole; hits on dead rows in a block that is partly alive
+    // are filtered out when searching
+    while (!idx->blocks.empty() && idx->blocks.front().first_row + idx->blocks.front().rows <= oldest_row)
+        drop_oldest_block(idx);
+
+    size_t cap = mini_t_config().search_index_bytes;
+    size_t target = cap / 4 * 3;
+    if (index_bytes(idx) > cap)
+        while (!idx->blocks.empty() && index_bytes(idx) > target) drop_oldest_block(idx);
+    if (idx->line_starts.empty() || !idx->blocks.empty()) return;
+
+    size_t rows = idx->line_starts.size();
+    size_t drop = oldest_row > idx->first_row ? std::min((size_t)(oldest_row - idx->first_row), rows) : 0;
+    // Compact only once a quarter of the buffer is dead to keep erasing amortised
+    if (drop >= rows / 4 || drop == rows) {
+        if (drop) drop_oldest_rows(idx, drop);
+        drop = 0;
+    }
+
+    // Past the cap, evict down to three quarters of it for the same reason
+    if (index_bytes(idx) <= cap) return;
+    rows = idx->line_starts.size();
+    while (drop < rows && index_bytes(idx) - idx->line_starts[drop] - drop * sizeof(size_t) > target) drop++;
+    drop_oldest_rows(idx, drop);
+}
+
+static void clear_index(ScrollbackIndex *idx, glong row) {
+    idx->blocks.clear();
+    idx->block_bytes = 0;
+    idx->text.clear();
+    idx->line_starts.clear();
+    idx->first_row = idx->next_row = row;
+}
+
+// Forget rows from row on, e.g. ones a program has since redrawn
+static void truncate_index(ScrollbackIndex *idx, glong row) {
+    size_t line = row - idx->first_row;
+    idx->text.resize(idx->line_starts[line]);
+    idx->line_starts.resize(line);
+    idx->next_row = row;
+}
+
+static size_t trimmed_length(const char *text) {
+    size_t len = text ? std::strlen(text) : 0;
+    while (len > 0 && (text[len - 1] == '\n' || text[len - 1] == '\r')) len--;
+    return len;
+}
+
+// First of the last few indexed rows whose text VTE no longer has at that
+// row; next_row if they all still match
+static glong first_stale_row(const ScrollbackIndex *idx, glong oldest_row, glong end_of_screen) {
+    for (glong row = std::max(idx->first_row, idx->next_row - VERIFY_ROWS); row < idx->next_row; row++) {
+        if (row < oldest_row || row >= end_of_screen) return row;
+        size_t line = row - idx->first_row;
+        size_t start = idx->line_starts[line];
+        size_t end = line + 1 < idx->line_starts.size() ? idx->line_starts[line + 1] - 1 : idx->text.size() - 1;
+
+        char *text = row_text(idx->terminal, row);
+        size_t len = trimmed_length(text);
+        bool same = len == end - start && std::memcmp(text ? text : "", idx->text.data() + start, len) == 0;
+        g_free(text);
+        if (!same) return row;
+    }
+    return idx->next_row;
+}
+
+// Returns whether rows above the cursor are still waiting
+static bool index_rows(ScrollbackIndex *idx, glong batch) {
+    TRACE_SCOPE("index_pending_rows");
+    VteTerminal *terminal = idx->terminal;
+
+    glong column, cursor_row;
+    vte_terminal_get_cursor_position(terminal, &column, &cursor_row);
+    GtkAdjustment *adj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(terminal));
+    glong oldest_row = (glong)gtk_adjustment_get_lower(adj);
+    glong end_of_screen = (glong)gtk_adjustment_get_upper(adj);
+    glong columns = vte_terminal_get_column_count(terminal);
+    // The alternate screen (vim, less, man) never has any
+    bool has_history = end_of_screen - oldest_row > vte_terminal_get_row_count(terminal);
+    glong indexed_before = idx->next_row;
+
+    if (columns != idx->columns) {
+        // A rewrap renumbered every row
+        idx->columns = columns;
+        clear_index(idx, oldest_row);
+    } else if (idx->paused || cursor_row < idx->next_row || oldest_row < idx->lower) {
+        // The cursor went back above indexed rows. Either a program redrew
+        // them, the alternate screen came up with its own numbering from 0,
+        // or a reset renumbered everything. The last indexed rows tell which.
+        glong checked_from = std::max(idx->first_row, idx->next_row - VERIFY_ROWS);
+        glong stale = idx->line_starts.empty() ? checked_from : first_stale_row(idx, oldest_row, end_of_screen);
+        if (stale > checked_from || (stale == idx->next_row && !index_empty(idx))) {
+            // Still the same rows, or back on them after the alternate screen
+            if (stale < idx->next_row) truncate_index(idx, stale);
+            idx->paused = false;
+        } else if (has_history || (!idx->paused && index_empty(idx))) {
+            // Renumbered (reset); nothing to pick up from
+            clear_index(idx, oldest_row);
+            idx->paused = false;
+        } else {
+            // Keep the normal screen's rows and wait for it to come back
+            idx->paused = true;
+        }
+    }
+    if (!idx->paused && idx->next_row < oldest_row) {
+        // Output outran the indexer; skip what VTE has already dropped
+        clear_index(idx, oldest_row);
+    }
+    // Results already listed may point at rows that changed
+    if (idx->next_row < indexed_before && search_window) run_search();
+    if (idx->paused) return false;
+    idx->lower = oldest_row;
+    if (idx->line_starts.empty()) idx->first_row = idx->next_row;
+
+    // The cursor row may still be written to, so only index rows above it
+    glong end_row = idx->next_row + std::min(std::max(0L, cursor_row - idx->next_row), batch);
+    for (glong row = idx->next_row; row < end_row; row++) {
+        char *text = row_text(terminal, row);
+        size_t len = trimmed_length(text);
+
+        idx->line_starts.push_back(idx->text.size());
+        idx->text.append(text ? text : "", len);
+        idx->text.push_back('\n');
+        g_free(text);
+    }
+    TRACE_COUNTER("indexed rows", std::max(0L, end_row - idx->next_row));
+    idx->next_row = std::max(idx->next_row, end_row);
+    seal_rows(idx);
+    prune_index(idx, oldest_row);
+    return idx->next_row < cursor_row;
+}
+
+// Hidden tabs are indexed less often, in larger batches
+static bool index_throttled(const ScrollbackIndex *idx) {
+    return mini_t_config().background_throttle && tab_in_background(GTK_WIDGET(idx->terminal));
+}
+
+static gboolean index_pending_rows(gpointer user_data) {
+    ScrollbackIndex *idx = (ScrollbackIndex*)user_data;
+    if (index_rows(idx, index_throttled(idx) ? BACKGROUND_INDEX_ROWS_PER_TICK : INDEX_ROWS_PER_TICK)) return G_SOURCE_CONTINUE;
+    idx->source_id = 0;
+    return G_SOURCE_REMOVE;
+}
+
+static void on_contents_changed(VteTerminal *terminal, gpointer user_data) {
+    (void)terminal; // unused
+    ScrollbackIndex *idx = (ScrollbackIndex*)user_data;
+    if (idx->source_id) return;
+
+    guint interval = index_throttled(idx) ? BACKGROUND_INDEX_INTERVAL_MS : INDEX_INTERVAL_MS;
+    idx->source_id = g_timeout_add(interval, index_pending_rows, idx);
+}
+
+static void on_terminal_destroy(GtkWidget*, gpointer user_data) {
+    ScrollbackIndex *idx = (ScrollbackIndex*)user_data;
+    if (idx->source_id) g_source_remove(idx->source_id);
+    indexes.erase(std::remove(indexes.begin(), indexes.end(), idx), indexes.end());
+    delete idx;
+}
+
+void search_attach(VteTerminal *terminal) {
+    ScrollbackIndex *idx = new ScrollbackIndex();
+    Tab *tab = tab_for(terminal);
+    idx->tab_id = tab ? tab->id : 0;
+    idx->terminal = terminal;
+    idx->block_bytes = 0;
+    idx->first_row = idx->next_row = 0;
+    idx->lower = 0;
+    idx->columns = vte_terminal_get_column_count(terminal);
+    idx->paused = false;
+    idx->source_id = 0;
+    indexes.push_back(idx);
+
+    g_signal_connect(terminal, "contents-changed", G_CALLBACK(on_contents_changed), idx);
+    g_signal_connect(terminal, "destroy", G_CALLBACK(on_terminal_destroy), idx);
+}
+
+// -------------------- Searching --------------------
+// One stretch of indexed rows, starting at first_row; at most one hit per row
+// and none on rows VTE has dropped since
+struct SearchText {
+    guint tab_id;
+    const char *text;
+    size_t len;
+    glong first_row;
+    glong oldest_row;
+};
+
+// Record the row holding text[offset]; returns where the next row starts
+static size_t add_hit(std::vector<SearchHit> &hits, const SearchText &st, size_t offset, glong &row, size_t &counted) {
+    row += std::count(st.text + counted, st.text + offset, '\n');
+    const char *start = (const char*)memrchr(st.text, '\n', offset);
+    start = start ? start + 1 : st.text;
+    const char *end = (const char*)std::memchr(st.text + offset, '\n', st.len - offset);
+    if (!end) end = st.text + st.len;
+    if (row >= st.oldest_row) hits.push_back({st.tab_id, row, std::string(start, end)});
+    counted = end - st.text;
+    return counted + 1;
+}
+
+// Plain case-sensitive text: one memmem pass over the contiguous rows
+static void search_literal(const SearchText &st, const std::string &query, std::vector<SearchHit> &hits) {
+    glong row = st.first_row;
+    size_t counted = 0, pos = 0;
+    while (hits.size() < MAX_RESULTS && pos < st.len) {
+        const void *found = memmem(st.text + pos, st.len - pos, query.data(), query.size());
+        if (!found) break;
+        pos = add_hit(hits, st, (const char*)found - st.text, row, counted);
+    }
+}
+
+static void search_regex(const SearchText &st, GRegex *regex, std::vector<SearchHit> &hits) {
+    if (st.len == 0) return;
+
+    GMatchInfo *info = nullptr;
+    glong row = st.first_row;
+    size_t counted = 0, next_line = 0;
+    g_regex_match_full(regex, st.text, st.len, 0, (GRegexMatchFlags)0, &info, nullptr);
+    while (hits.size() < MAX_RESULTS && g_match_info_matches(info)) {
+        gint start, end;
+        g_match_info_fetch_pos(info, 0, &start, &end);
+        if ((size_t)start >= next_line) next_line = add_hit(hits, st, start, row, counted);
+        g_match_info_next(info, nullptr);
+    }
+    g_match_info_free(info);
+}
+
+// literal is the query when it is plain text (either case), for the trigram filter
+static void search_index(const ScrollbackIndex *idx, const std::string &literal, GRegex *regex,
+                         std::string &scratch, std::vector<SearchHit> &hits) {
+    auto search = [&](const SearchText &st) {
+        if (regex) search_regex(st, regex, hits);
+        else search_literal(st, literal, hits);
+    };
+
+    for (const IndexBlock &block : idx->blocks) {
+        if (hits.size() >= MAX_RESULTS) return;
+        if (!may_contain(block, literal)) continue;
+        scratch.resize(block.text_bytes);
+        uLongf size = block.text_bytes;
+        if (uncompress((Bytef*)&scratch[0], &size, block.compressed.data(), block.compressed.size()) != Z_OK) continue;
+        search({idx->tab_id, scratch.data(), size, block.first_row, idx->lower});
+    }
+    if (hits.size() < MAX_RESULTS) search({idx->tab_id, idx->text.data(), idx->text.size(), idx->first_row, idx->lower});
+}
+
+static std::string tab_title(VteTerminal *terminal) {
+    if (!terminal) return "";
+    GtkWidget *label_box = gtk_notebook_get_tab_label(global_notebook, GTK_WIDGET(terminal));
+    if (!label_box) return "";
+    GList *children = gtk_container_get_children(GTK_CONTAINER(label_box));
+    std::string title = children && GTK_IS_LABEL(children->data) ? gtk_label_get_text(GTK_LABEL(children->data)) : "";
+    g_list_free(children);
+    return title;
+}
+
+static void run_search() {
+    TRACE_SCOPE("run_search");
+    gtk_list_store_clear(results);
+    std::string query = gtk_entry_get_text(GTK_ENTRY(search_entry));
+    if (query.empty()) {
+        gtk_label_set_text(GTK_LABEL(status_label), "");
+        return;
+    }
+
+    bool use_regex = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(regex_check));
+    bool match_case = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(case_check));
+    gint64 started = g_get_monotonic_time();
+    std::vector<SearchHit> hits;
+
+    GRegex *regex = nullptr;
+    if (use_regex || !match_case) {
+        // RAW skips UTF-8 validation of the whole buffer on every query
+        int flags = G_REGEX_MULTILINE | G_REGEX_OPTIMIZE | G_REGEX_RAW;
+        if (!match_case) flags |= G_REGEX_CASELESS;
+        char *pattern = use_regex ? g_strdup(query.c_str()) : g_regex_escape_string(query.c_str(), -1);
+        GError *error = nullptr;
+        regex = g_regex_new(pattern, (GRegexCompileFlags)flags, (GRegexMatchFlags)0, &error);
+        g_free(pattern);
+        if (!regex) {
+            gtk_label_set_text(GTK_LABEL(status_label), error->message);
+            g_error_free(error);
+            return;
+        }
+    }
+
+    std::string literal = use_regex ? "" : query;
+    std::string scratch;
+    glong unindexed_rows = 0;
+    int unindexed_tabs = 0;
+    for (ScrollbackIndex *idx : indexes) {
+        if (hits.size() < MAX_RESULTS) search_index(idx, literal, regex, scratch, hits);
+        // Rows VTE still has that were evicted from the index
+        glong missing = oldest_indexed_row(idx) - idx->lower;
+        if (missing > 0) {
+            unindexed_rows += missing;
+            unindexed_tabs++;
+        }
+    }
+    if (regex) g_regex_unref(regex);
+
+    double elapsed_ms = (g_get_monotonic_time() - started) / 1000.0;
+    for (const SearchHit &hit : hits) {
+        VteTerminal *terminal = nullptr;
+        for (ScrollbackIndex *idx : indexes)
+            if (idx->tab_id == hit.tab_id) terminal = idx->terminal;
+
+        GtkTreeIter iter;
+        gtk_list_store_append(results, &iter);
+        gtk_list_store_set(results, &iter,
+                           RES_TAB, tab_title(terminal).c_str(),
+                           RES_ROW, (gint64)hit.row + 1,
+                           RES_LINE, hit.line.c_str(),
+                           RES_TAB_ID, hit.tab_id,
+                           -1);
+    }
+
+    char *status = g_strdup_printf("%zu%s matches in %.1f ms", hits.size(),
+                                   hits.size() >= MAX_RESULTS ? "+" : "", elapsed_ms);
+    if (unindexed_rows > 0) {
+        char *coverage = g_strdup_printf("%s; %ld older rows in %d %s not indexed (MINI_T_SEARCH_INDEX_MB)", status,
+                                         unindexed_rows, unindexed_tabs, unindexed_tabs == 1 ? "tab" : "tabs");
+        g_free(status);
+        status = coverage;
+    }
+    gtk_label_set_text(GTK_LABEL(status_label), status);
+    g_free(status);
+}
+
+// Switch to the tab and scroll the matching row into the middle of the view
+static void jump_to(guint tab_id, glong row) {
+    for (ScrollbackIndex *idx : indexes) {
+        if (idx->tab_id != tab_id) continue;
+
+        GtkWidget *page = GTK_WIDGET(idx->terminal);
+        gtk_notebook_set_current_page(global_notebook, gtk_notebook_page_num(global_notebook, page));
+
+        GtkAdjustment *adj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(idx->terminal));
+        double value = row - vte_terminal_get_row_count(idx->terminal) / 2;
+        double max_value = gtk_adjustment_get_upper(adj) - gtk_adjustment_get_page_size(adj);
+        gtk_adjustment_set_value(adj, CLAMP(value, gtk_adjustment_get_lower(adj), max_value));
+        gtk_widget_grab_focus(page);
+        return;
+    }
+    gtk_label_set_text(GTK_LABEL(status_label), "That tab has been closed");
+}
+
+static void on_result_activated(GtkTreeView*, GtkTreePath *path, GtkTreeViewColumn*, gpointer) {
+    GtkTreeIter iter;
+    if (!gtk_tree_model_get_iter(GTK_TREE_MODEL(results), &iter, path)) return;
+
+    guint tab_id;
+    gint64 row;
+    gtk_tree_model_get(GTK_TREE_MODEL(results), &iter, RES_TAB_ID, &tab_id, RES_ROW, &row, -1);
+    jump_to(tab_id, (glong)row - 1);
+}
+
+static void on_query_changed(GtkWidget*, gpointer) { run_search(); }
+
+static void on_search_window_destroy(GtkWidget*, gpointer) {
+    search_window = nullptr;
+    g_object_unref(results);
+}
+
+static void create_search_window(GtkWindow *parent) {
+    search_window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(search_window), "Search Tabs");
+    gtk_window_set_default_size(GTK_WINDOW(search_window), 700, 400);
+    gtk_window_set_transient_for(GTK_WINDOW(search_window), parent);
+
+    GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 6);
+    gtk_container_add(GTK_CONTAINER(search_window), vbox);
+
+    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    search_entry = gtk_search_entry_new();
+    regex_check = gtk_check_button_new_with_label("Regex");
+    case_check = gtk_check_button_new_with_label("Match case");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(case_check), TRUE);
+    gtk_box_pack_start(GTK_BOX(hbox), search_entry, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), regex_check, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), case_check, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    status_label = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(status_label), 0.0);
+    gtk_box_pack_start(GTK_BOX(vbox), status_label, FALSE, FALSE, 0);
+
+    results = gtk_list_store_new(RES_N_COLUMNS, G_TYPE_STRING, G_TYPE_INT64, G_TYPE_STRING, G_TYPE_UINT);
+    GtkWidget *tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(results));
+
+    GtkCellRenderer *tab_renderer = gtk_cell_renderer_text_new();
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view),
+        gtk_tree_view_column_new_with_attributes("Tab", tab_renderer, "text", RES_TAB, NULL));
+
+    GtkCellRenderer *row_renderer = gtk_cell_renderer_text_new();
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view),
+        gtk_tree_view_column_new_with_attributes("Line", row_renderer, "text", RES_ROW, NULL));
+
+    GtkCellRenderer *line_renderer = gtk_cell_renderer_text_new();
+    g_object_set(line_renderer, "family", "Monospace", NULL);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view),
+        gtk_tree_view_column_new_with_attributes("Text", line_renderer, "text", RES_LINE, NULL));
+
+    GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
+    gtk_container_add(GTK_CONTAINER(scrolled), tree_view);
+    gtk_box_pack_start(GTK_BOX(vbox), scrolled, TRUE, TRUE, 0);
+
+    g_signal_connect(search_entry, "search-changed", G_CALLBACK(on_query_changed), NULL);
+    g_signal_connect(regex_check, "toggled", G_CALLBACK(on_query_changed), NULL);
+    g_signal_connect(case_check, "toggled", G_CALLBACK(on_query_changed), NULL);
+    g_signal_connect(tree_view, "row-activated", G_CALLBACK(on_result_activated), NULL);
+    g_signal_connect(search_window, "destroy", G_CALLBACK(on_search_window_destroy), NULL);
+}
+
+// Search dialog
+void on_search_tabs(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    (void)action;    // unused
+    (void)parameter; // unused
+
+    GtkWindow *parent = GTK_WINDOW(gtk_application_get_active_window(GTK_APPLICATION(user_data)));
+    if (!search_window) create_search_window(parent);
+
+    gtk_widget_show_all(search_window);
+    gtk_window_present(GTK_WINDOW(search_window));
+    gtk_widget_grab_focus(search_entry);
+}
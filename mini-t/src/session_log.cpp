@@ -0,0 +1,223 @@
+#include "session_log.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+static const size_t RING_BYTES = 4 * 1024 * 1024; // power of two
+static const auto FLUSH_INTERVAL = std::chrono::seconds(1);
+static const auto SHUTDOWN_WAIT = std::chrono::seconds(5);
+
+struct SessionLog {
+    std::vector<char> ring = std::vector<char>(RING_BYTES);
+    std::atomic<size_t> head{0}; // advanced by the producer (PTY relay thread)
+    std::atomic<size_t> tail{0}; // advanced by the writer thread
+    std::atomic<bool> stopping{false};
+
+    // An idle writer blocks on wake; the producer only takes the mutex to
+    // notify when the writer has said it is going to sleep
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping{false};
+
+    std::atomic<uint64_t> written_bytes{0};
+    std::atomic<uint64_t> dropped_writes{0};
+    std::atomic<uint64_t> dropped_bytes{0};
+
+    bool timestamps = false;
+    bool line_start = true; // producer side: the next byte begins a line
+    FILE *file = nullptr;
+    gzFile gz = nullptr;
+    std::thread writer;
+};
+
+// Logs handed to their writer thread by session_log_close, still draining
+static std::mutex closing_mutex;
+static std::condition_variable closing_done;
+static int closing = 0;
+
+static void wake_writer(SessionLog *log) {
+    if (!log->sleeping.load()) return;
+    std::lock_guard<std::mutex> lock(log->mutex);
+    log->wake.notify_one();
+}
+
+static void write_out(SessionLog *log, const char *data, size_t len) {
+    TRACE_SCOPE("session_log write");
+    if (log->gz) gzwrite(log->gz, data, (unsigned)len);
+    else fwrite(data, 1, len, log->file);
+}
+
+static void flush_out(SessionLog *log) {
+    // Z_SYNC_FLUSH keeps the .gz readable up to here while the tab is still open
+    if (log->gz) gzflush(log->gz, Z_SYNC_FLUSH);
+    else fflush(log->file);
+}
+
+static void writer_main(SessionLog *log) {
+    const size_t mask = log->ring.size() - 1;
+    uint64_t reported_drops = 0;
+    bool dirty = false;
+    auto last_flush = std::chrono::steady_clock::now();
+
+    for (;;) {
+        bool stop = log->stopping.load(std::memory_order_acquire);
+        size_t head = log->head.load(std::memory_order_acquire);
+        size_t tail = log->tail.load(std::memory_order_relaxed);
+
+        uint64_t drops = log->dropped_bytes.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            char note[96];
+            int n = std::snprintf(note, sizeof(note), "\n[mini-t: %llu bytes dropped]\n",
+                                  (unsigned long long)(drops - reported_drops));
+            write_out(log, note, n);
+            reported_drops = drops;
+            dirty = true;
+        }
+
+        if (head == tail) {
+            if (stop) break;
+            auto now = std::chrono::steady_clock::now();
+            if (dirty && now - last_flush >= FLUSH_INTERVAL) {
+                flush_out(log);
+                dirty = false;
+                last_flush = now;
+            }
+
+            // Announce the sleep before the last look at head, so an append
+            // either is seen here or sees sleeping and notifies
+            std::unique_lock<std::mutex> lock(log->mutex);
+            log->sleeping.store(true);
+            if (log->head.load() == tail && !log->stopping.load()) {
+                if (dirty) log->wake.wait_for(lock, FLUSH_INTERVAL - (now - last_flush));
+                else log->wake.wait(lock);
+            }
+            log->sleeping.store(false);
+            continue;
+        }
+
+        // Write the contiguous run up to the end of the ring; the rest comes next pass
+        size_t offset = tail & mask;
+        size_t len = std::min(head - tail, log->ring.size() - offset);
+        write_out(log, log->ring.data() + offset, len);
+        log->tail.store(tail + len, std::memory_order_release);
+        log->written_bytes.fetch_add(len, std::memory_order_relaxed);
+        dirty = true;
+    }
+
+    // Closing is left to this thread so the GTK thread never waits on the disk.
+    // Taking the mutex once makes sure session_log_close has let go of it.
+    if (log->gz) gzclose(log->gz);
+    else std::fclose(log->file);
+    { std::lock_guard<std::mutex> lock(log->mutex); }
+    delete log;
+
+    std::lock_guard<std::mutex> lock(closing_mutex);
+    closing--;
+    closing_done.notify_all();
+}
+
+SessionLog* session_log_open(const std::string &path, bool compress, bool timestamps) {
+    SessionLog *log = new SessionLog();
+    log->timestamps = timestamps;
+    if (compress) log->gz = gzopen(path.c_str(), "wb1");
+    else log->file = std::fopen(path.c_str(), "wb");
+
+    if (!log->gz && !log->file) {
+        delete log;
+        return nullptr;
+    }
+    log->writer = std::thread(writer_main, log);
+    return log;
+}
+
+static size_t ring_copy(SessionLog *log, size_t head, const char *data, size_t len) {
+    const size_t mask = log->ring.size() - 1;
+    size_t offset = head & mask;
+    size_t first = std::min(len, log->ring.size() - offset);
+    std::memcpy(log->ring.data() + offset, data, first);
+    std::memcpy(log->ring.data(), data + first, len - first);
+    return head + len;
+}
+
+void session_log_write(SessionLog *log, const char *data, size_t len) {
+    char stamp[40];
+    size_t stamp_len = 0;
+    size_t lines = 0;
+    if (log->timestamps) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        struct tm local;
+        localtime_r(&ts.tv_sec, &local);
+        stamp_len = std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &local);
+        stamp_len += std::snprintf(stamp + stamp_len, sizeof(stamp) - stamp_len, ".%03ld ", ts.tv_nsec / 1000000);
+
+        // Lines starting in this chunk: the first if the last chunk ended one,
+        // plus one after every newline that isn't the final byte
+        lines = log->line_start ? 1 : 0;
+        for (const char *p = data; (p = (const char*)std::memchr(p, '\n', data + len - p)) && p + 1 < data + len; p++)
+            lines++;
+    }
+
+    size_t head = log->head.load(std::memory_order_relaxed);
+    size_t tail = log->tail.load(std::memory_order_acquire);
+    size_t needed = len + lines * stamp_len;
+    if (log->ring.size() - (head - tail) < needed) {
+        log->dropped_writes.fetch_add(1, std::memory_order_relaxed);
+        log->dropped_bytes.fetch_add(len, std::memory_order_relaxed);
+        wake_writer(log);
+        return;
+    }
+
+    if (!log->timestamps) {
+        head = ring_copy(log, head, data, len);
+    } else {
+        const char *end = data + len;
+        for (const char *p = data; p < end;) {
+            if (log->line_start) head = ring_copy(log, head, stamp, stamp_len);
+            const char *nl = (const char*)std::memchr(p, '\n', end - p);
+            const char *next = nl ? nl + 1 : end;
+            head = ring_copy(log, head, p, next - p);
+            log->line_start = nl != nullptr;
+            p = next;
+        }
+    }
+    log->head.store(head);
+    wake_writer(log);
+}
+
+SessionLogStats session_log_stats(const SessionLog *log) {
+    return {
+        log->written_bytes.load(std::memory_order_relaxed),
+        log->dropped_writes.load(std::memory_order_relaxed),
+        log->dropped_bytes.load(std::memory_order_relaxed),
+    };
+}
+
+void session_log_close(SessionLog *log) {
+    {
+        std::lock_guard<std::mutex> lock(closing_mutex);
+        closing++;
+    }
+    log->writer.detach();
+
+    // The writer may free the log as soon as it sees stopping; it waits for
+    // this lock first, and nothing touches the log after it is released
+    std::lock_guard<std::mutex> lock(log->mutex);
+    log->stopping.store(true);
+    log->wake.notify_one();
+}
+
+void session_log_shutdown() {
+    std::unique_lock<std::mutex> lock(closing_mutex);
+    if (!closing_done.wait_for(lock, SHUTDOWN_WAIT, [] { return closing == 0; }))
+        std::fprintf(stderr, "mini-t: %d session logs still writing at exit\n", closing);
+}
@@ -0,0 +1,116 @@
+#include "shell_pool.hpp"
+#include "config.hpp"
+#include "terminal.hpp"
+#include <deque>
+#include <csignal>
+#include <sys/wait.h>
+
+static std::deque<PooledShell> ready;
+static int pending = 0;
+static guint refill_source = 0;
+static bool shutting_down = false;
+
+static void on_pool_spawned(GObject *source, GAsyncResult *result, gpointer user_data) {
+    (void)user_data; // unused
+    VtePty *pty = VTE_PTY(source);
+    GPid pid = -1;
+    GError *error = nullptr;
+    pending--;
+
+    if (!vte_pty_spawn_finish(pty, result, &pid, &error)) {
+        g_printerr("mini-t: failed to pre-spawn shell: %s\n", error->message);
+        g_error_free(error);
+        g_object_unref(pty);
+        return;
+    }
+    if (shutting_down) {
+        kill(pid, SIGHUP);
+        g_object_unref(pty);
+        return;
+    }
+    ready.push_back({pty, pid});
+}
+
+static void spawn_pooled_shell() {
+    GError *error = nullptr;
+    VtePty *pty = vte_pty_new_sync(VTE_PTY_DEFAULT, nullptr, &error);
+    if (!pty) {
+        g_printerr("mini-t: failed to open PTY: %s\n", error->message);
+        g_error_free(error);
+        return;
+    }
+    // Real size arrives when a tab adopts the PTY; the shell redraws on SIGWINCH
+    vte_pty_set_size(pty, 24, 80, nullptr);
+
+    char **envv = terminal_child_environ();
+
+    char *argv_shell[] = {(char*)terminal_style().shell.c_str(), nullptr};
+    pending++;
+    vte_pty_spawn_async(
+        pty,
+        nullptr,
+        argv_shell,
+        envv,
+        (GSpawnFlags)(G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH),
+        nullptr, nullptr,
+        nullptr,
+        -1,
+        nullptr,
+        on_pool_spawned,
+        nullptr
+    );
+    g_strfreev(envv);
+}
+
+static void shell_pool_fill() {
+    if (shutting_down) return;
+    while ((int)ready.size() + pending < mini_t_config().shell_pool_size)
+        spawn_pooled_shell();
+}
+
+static gboolean refill_pool(gpointer) {
+    refill_source = 0;
+    shell_pool_fill();
+    return G_SOURCE_REMOVE;
+}
+
+static void schedule_refill() {
+    if (!refill_source && !shutting_down && mini_t_config().shell_pool_size > 0)
+        refill_source = g_timeout_add(mini_t_config().shell_pool_refill_ms, refill_pool, nullptr);
+}
+
+void shell_pool_start() { schedule_refill(); }
+
+bool shell_pool_take(PooledShell *shell) {
+    bool found = false;
+    while (!found && !ready.empty()) {
+        PooledShell candidate = ready.front();
+        ready.pop_front();
+
+        // Nothing else watches pooled children, so reaping one that died idle is safe
+        int status;
+        if (waitpid(candidate.pid, &status, WNOHANG) == 0) {
+            *shell = candidate;
+            found = true;
+        } else {
+            g_object_unref(candidate.pty);
+        }
+    }
+
+    // Refill after a delay so the fork doesn't compete with this tab's first frame
+    schedule_refill();
+    return found;
+}
+
+// The application is exiting; idle shells just need their hangup
+void shell_pool_shutdown() {
+    shutting_down = true;
+    if (refill_source) g_source_remove(refill_source);
+    refill_source = 0;
+
+    for (PooledShell &shell : ready) {
+        kill(shell.pid, SIGHUP);
+        g_object_unref(shell.pty);
+    }
+    ready.clear();
+}
@@ -0,0 +1,362 @@
+#include "tab.hpp"
+#include "pty_relay.hpp"
+#include "terminal.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <malloc.h>
+#include <set>
+#include <string>
+#include <sys/wait.h>
+
+// Children get this long to exit after SIGHUP before the session is killed;
+// whatever is left is killed again at the same interval until none remain
+static const guint REAP_GRACE_SECONDS = 3;
+
+static std::vector<Tab*> tabs;
+static guint next_tab_id = 1;
+
+struct Reaper {
+    GPid pid;    // the shell, whose pid is also its session id
+    bool reaped; // the shell itself; its jobs may still be running
+    guint kill_source;
+};
+
+static int reapers = 0;
+
+enum { DIAG_TAB, DIAG_PID, DIAG_PTY, DIAG_STATUS, DIAG_RSS, DIAG_FDS, DIAG_N_COLUMNS };
+
+static GtkWidget *diag_window = nullptr;
+static GtkWidget *diag_summary;
+static GtkListStore *diag_store;
+static guint diag_source = 0;
+
+// -------------------- Registry --------------------
+static void on_child_exited(VteTerminal *terminal, gint status, gpointer) {
+    tab_set_exited(terminal, status);
+}
+
+static void on_terminal_destroy(GtkWidget*, gpointer user_data) {
+    Tab *tab = (Tab*)user_data;
+    if (tab->pty) g_object_unref(tab->pty);
+    if (tab->relay) pty_relay_release(tab->relay);
+    tabs.erase(std::remove(tabs.begin(), tabs.end(), tab), tabs.end());
+    delete tab;
+}
+
+Tab* tab_attach(VteTerminal *terminal) {
+    Tab *tab = new Tab();
+    tab->id = next_tab_id++;
+    tab->terminal = terminal;
+    tab->pid = -1;
+    tab->pty = nullptr;
+    tab->relay = nullptr;
+    tab->exited = false;
+    tab->exit_status = 0;
+    tab->runs_shell = true;
+    tab->spinner = nullptr;
+    tab->marker = nullptr;
+    tab->busy = false;
+    tab->unseen = false;
+    tab->sampled_pgid = -1;
+    tab->sampled_us = 0;
+    tab->sampled_ticks = tab->sampled_rchar = tab->sampled_wchar = 0;
+    tabs.push_back(tab);
+
+    g_signal_connect(terminal, "child-exited", G_CALLBACK(on_child_exited), nullptr);
+    g_signal_connect(terminal, "destroy", G_CALLBACK(on_terminal_destroy), tab);
+    return tab;
+}
+
+Tab* tab_for(VteTerminal *terminal) {
+    for (Tab *tab : tabs)
+        if (tab->terminal == terminal) return tab;
+    return nullptr;
+}
+
+const std::vector<Tab*>& all_tabs() { return tabs; }
+
+void tab_set_child(VteTerminal *terminal, GPid pid, VtePty *pty, PtyRelay *relay) {
+    Tab *tab = tab_for(terminal);
+    if (!tab) return;
+    tab->pid = pid;
+    if (pty && !tab->pty) tab->pty = VTE_PTY(g_object_ref(pty));
+    tab->relay = relay;
+}
+
+void tab_set_exited(VteTerminal *terminal, int status) {
+    Tab *tab = tab_for(terminal);
+    if (!tab) return;
+    tab->exited = true;
+    tab->exit_status = status;
+    if (tab->pty) g_object_unref(tab->pty);
+    tab->pty = nullptr;
+}
+
+// -------------------- Closing --------------------
+// Process groups with a live process in session sid. Job-control shells put
+// every job in a group of its own, so signalling the shell's group isn't enough.
+static std::set<pid_t> session_groups(pid_t sid) {
+    std::set<pid_t> groups;
+    DIR *proc = opendir("/proc");
+    if (!proc) return groups;
+
+    while (struct dirent *entry = readdir(proc)) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') continue;
+        char path[64], buf[512];
+        std::snprintf(path, sizeof(path), "/proc/%s/stat", entry->d_name);
+        FILE *f = std::fopen(path, "r");
+        if (!f) continue;
+        size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+        std::fclose(f);
+        buf[n] = '\0';
+
+        // The command name may contain spaces and parentheses; fields resume after the last ')'
+        const char *fields = std::strrchr(buf, ')');
+        char state;
+        int ppid, pgrp, session;
+        if (!fields || std::sscanf(fields + 1, " %c %d %d %d", &state, &ppid, &pgrp, &session) != 4) continue;
+        if (session == sid && state != 'Z') groups.insert(pgrp);
+    }
+    closedir(proc);
+    return groups;
+}
+
+static bool signal_session(pid_t sid, int sig) {
+    std::set<pid_t> groups = session_groups(sid);
+    for (pid_t pgrp : groups) kill(-pgrp, sig);
+    return !groups.empty();
+}
+
+static void free_reaper(Reaper *reaper) {
+    if (reaper->kill_source) g_source_remove(reaper->kill_source);
+    delete reaper;
+    reapers--;
+}
+
+static void on_reaped(GPid pid, gint, gpointer user_data) {
+    Reaper *reaper = (Reaper*)user_data;
+    reaper->reaped = true;
+    g_spawn_close_pid(pid);
+    if (session_groups(pid).empty()) free_reaper(reaper);
+
+    // Hand the freed tab's heap back to the kernel so closed tabs don't pin RSS
+    malloc_trim(0);
+}
+
+// Jobs that ignored SIGHUP, and anything they started since, until the session is empty
+static gboolean kill_session(gpointer user_data) {
+    Reaper *reaper = (Reaper*)user_data;
+    if (signal_session(reaper->pid, SIGKILL) || !reaper->reaped) return G_SOURCE_CONTINUE;
+    reaper->kill_source = 0;
+    free_reaper(reaper);
+    return G_SOURCE_REMOVE;
+}
+
+int tab_reapers_pending() { return reapers; }
+
+static void on_close_clicked(GtkButton*, gpointer user_data) {
+    tab_close(global_notebook, VTE_TERMINAL(user_data));
+}
+
+void tab_close(GtkNotebook *notebook, VteTerminal *terminal) {
+    Tab *tab = tab_for(terminal);
+    GPid pid = tab ? tab->pid : -1;
+    bool reaped = !tab || tab->exited;
+
+    // Destroying the terminal drops VTE's child watch and closes the PTY master,
+    // so from here on the child is ours to signal and reap
+    gint page = gtk_notebook_page_num(notebook, GTK_WIDGET(terminal));
+    if (page >= 0) gtk_notebook_remove_page(notebook, page);
+
+    if (pid <= 0) {
+        malloc_trim(0);
+        return;
+    }
+
+    // Once the shell is reaped its pid can only be reused after its whole
+    // session is gone, so a process holding it means there is nothing left.
+    // Unreaped and missing means VTE reaped it without emitting child-exited yet.
+    char *proc_path = g_strdup_printf("/proc/%d", (int)pid);
+    bool pid_exists = g_file_test(proc_path, G_FILE_TEST_EXISTS);
+    g_free(proc_path);
+    if (!reaped && !pid_exists) reaped = true;
+    if (reaped && pid_exists) {
+        malloc_trim(0);
+        return;
+    }
+
+    // The shell leads its own session, so its pid is also the session id
+    if (!signal_session(pid, SIGHUP) && reaped) {
+        malloc_trim(0);
+        return;
+    }
+    signal_session(pid, SIGCONT);
+
+    Reaper *reaper = new Reaper();
+    reapers++;
+    reaper->pid = pid;
+    reaper->reaped = reaped;
+    reaper->kill_source = g_timeout_add_seconds(REAP_GRACE_SECONDS, kill_session, reaper);
+    if (!reaped) g_child_watch_add(pid, on_reaped, reaper);
+}
+
+void tab_add(GtkNotebook *notebook, VteTerminal *terminal, const char *title) {
+    GtkWidget *label_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 4);
+    GtkWidget *label = gtk_label_new(title);
+    GtkWidget *marker = gtk_label_new("");
+    GtkWidget *spinner = gtk_spinner_new();
+    GtkWidget *close_btn = gtk_button_new_from_icon_name("window-close-symbolic", GTK_ICON_SIZE_MENU);
+    gtk_widget_set_can_focus(close_btn, FALSE);
+
+    // The title label stays first; search and diagnostics read it from there
+    gtk_box_pack_start(GTK_BOX(label_box), label, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(label_box), marker, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(label_box), spinner, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(label_box), close_btn, FALSE, FALSE, 0);
+    gtk_widget_show_all(label_box);
+    gtk_widget_hide(spinner);
+
+    Tab *tab = tab_for(terminal);
+    if (tab) {
+        tab->spinner = spinner;
+        tab->marker = marker;
+    }
+
+    gtk_notebook_append_page(notebook, GTK_WIDGET(terminal), label_box);
+    gtk_notebook_set_tab_reorderable(notebook, GTK_WIDGET(terminal), TRUE);
+    gtk_widget_show(GTK_WIDGET(terminal));
+    gtk_notebook_set_current_page(notebook, gtk_notebook_get_n_pages(notebook)-1);
+
+    g_signal_connect(close_btn, "clicked", G_CALLBACK(on_close_clicked), terminal);
+}
+
+// -------------------- Diagnostics --------------------
+static long proc_rss_kb(GPid pid) {
+    char *path = g_strdup_printf("/proc/%d/status", (int)pid);
+    char *contents = nullptr;
+    long rss = -1;
+    if (g_file_get_contents(path, &contents, nullptr, nullptr)) {
+        const char *line = strstr(contents, "VmRSS:");
+        if (line) rss = strtol(line + 6, nullptr, 10);
+    }
+    g_free(contents);
+    g_free(path);
+    return rss;
+}
+
+static int proc_fd_count(GPid pid) {
+    char *path = g_strdup_printf("/proc/%d/fd", (int)pid);
+    GDir *dir = g_dir_open(path, 0, nullptr);
+    g_free(path);
+    if (!dir) return -1;
+    int count = 0;
+    while (g_dir_read_name(dir)) count++;
+    g_dir_close(dir);
+    return count;
+}
+
+static std::string child_status(const Tab *tab) {
+    if (tab->pid <= 0) return "starting";
+    if (!tab->exited) return "running";
+    if (WIFEXITED(tab->exit_status)) return "exited " + std::to_string(WEXITSTATUS(tab->exit_status));
+    if (WIFSIGNALED(tab->exit_status)) return std::string("killed (") + g_strsignal(WTERMSIG(tab->exit_status)) + ")";
+    return "exited";
+}
+
+static std::string tab_label(const Tab *tab) {
+    GtkWidget *label_box = gtk_notebook_get_tab_label(global_notebook, GTK_WIDGET(tab->terminal));
+    std::string title = "#" + std::to_string(tab->id);
+    if (!label_box || !GTK_IS_CONTAINER(label_box)) return title;
+    GList *children = gtk_container_get_children(GTK_CONTAINER(label_box));
+    if (children && GTK_IS_LABEL(children->data))
+        title += " " + std::string(gtk_label_get_text(GTK_LABEL(children->data)));
+    g_list_free(children);
+    return title;
+}
+
+static gboolean refresh_diagnostics(gpointer) {
+    gtk_list_store_clear(diag_store);
+    for (const Tab *tab : tabs) {
+        bool running = tab->pid > 0 && !tab->exited;
+        char *pty_name = tab->pty ? ptsname(vte_pty_get_fd(tab->pty)) : nullptr;
+        long rss = running ? proc_rss_kb(tab->pid) : -1;
+        int fds = running ? proc_fd_count(tab->pid) : -1;
+
+        GtkTreeIter iter;
+        gtk_list_store_append(diag_store, &iter);
+        gtk_list_store_set(diag_store, &iter,
+                           DIAG_TAB, tab_label(tab).c_str(),
+                           DIAG_PID, (gint)tab->pid,
+                           DIAG_PTY, pty_name ? pty_name : "-",
+                           DIAG_STATUS, child_status(tab).c_str(),
+                           DIAG_RSS, rss >= 0 ? (std::to_string(rss) + " KB").c_str() : "-",
+                           DIAG_FDS, fds >= 0 ? std::to_string(fds).c_str() : "-",
+                           -1);
+    }
+
+    GPid self = getpid();
+    char *summary = g_strdup_printf("mini-t: %zu tabs, RSS %ld KB, %d open fds",
+                                    tabs.size(), proc_rss_kb(self), proc_fd_count(self));
+    gtk_label_set_text(GTK_LABEL(diag_summary), summary);
+    g_free(summary);
+    return G_SOURCE_CONTINUE;
+}
+
+static void on_diag_window_destroy(GtkWidget*, gpointer) {
+    g_source_remove(diag_source);
+    diag_source = 0;
+    diag_window = nullptr;
+    g_object_unref(diag_store);
+}
+
+static void add_diag_column(GtkWidget *tree_view, const char *title, int column) {
+    GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view),
+        gtk_tree_view_column_new_with_attributes(title, renderer, "text", column, NULL));
+}
+
+// Diagnostics window
+void on_diagnostics(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    (void)action;    // unused
+    (void)parameter; // unused
+
+    if (!diag_window) {
+        GtkWindow *parent = GTK_WINDOW(gtk_application_get_active_window(GTK_APPLICATION(user_data)));
+        diag_window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        gtk_window_set_title(GTK_WINDOW(diag_window), "Tab Diagnostics");
+        gtk_window_set_default_size(GTK_WINDOW(diag_window), 600, 300);
+        gtk_window_set_transient_for(GTK_WINDOW(diag_window), parent);
+
+        GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
+        gtk_container_set_border_width(GTK_CONTAINER(vbox), 6);
+        gtk_container_add(GTK_CONTAINER(diag_window), vbox);
+
+        diag_summary = gtk_label_new("");
+        gtk_label_set_xalign(GTK_LABEL(diag_summary), 0.0);
+        gtk_box_pack_start(GTK_BOX(vbox), diag_summary, FALSE, FALSE, 0);
+
+        diag_store = gtk_list_store_new(DIAG_N_COLUMNS, G_TYPE_STRING, G_TYPE_INT, G_TYPE_STRING,
+                                        G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+        GtkWidget *tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(diag_store));
+        add_diag_column(tree_view, "Tab", DIAG_TAB);
+        add_diag_column(tree_view, "PID", DIAG_PID);
+        add_diag_column(tree_view, "PTY", DIAG_PTY);
+        add_diag_column(tree_view, "Child", DIAG_STATUS);
+        add_diag_column(tree_view, "RSS", DIAG_RSS);
+        add_diag_column(tree_view, "FDs", DIAG_FDS);
+
+        GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
+        gtk_container_add(GTK_CONTAINER(scrolled), tree_view);
+        gtk_box_pack_start(GTK_BOX(vbox), scrolled, TRUE, TRUE, 0);
+
+        g_signal_connect(diag_window, "destroy", G_CALLBACK(on_diag_window_destroy), NULL);
+        refresh_diagnostics(nullptr);
+        diag_source = g_timeout_add_seconds(1, refresh_diagnostics, nullptr);
+    }
+
+    gtk_widget_show_all(diag_window);
+    gtk_window_present(GTK_WINDOW(diag_window));
+}
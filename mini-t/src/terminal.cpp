@@ -1,4 +1,12 @@
 #include "terminal.hpp"
+#include "config.hpp"
+#include "pty_relay.hpp"
+#include "search.hpp"
+#include "shell_pool.hpp"
+#include "session_log.hpp"
+#include "tab.hpp"
+#include "trace.hpp"
+#include <csignal>
 #include <cstring>
 #include <pwd.h>
 #include <vte/vte.h>
@@ -6,60 +14,102 @@
 bool splash_shown = false;
 GtkNotebook* global_notebook = nullptr;
 
-VteTerminal* spawn_terminal(GtkWidget *parent, bool splash) {
-    VteTerminal *terminal = VTE_TERMINAL(vte_terminal_new());
-    vte_terminal_set_scrollback_lines(terminal, 1000);
-
-    // Set font
-    PangoFontDescription *font = pango_font_description_from_string("Monospace 12");
-    vte_terminal_set_font(terminal, font);
-    pango_font_description_free(font);
-
-    // Nord-inspired colors
-    GdkRGBA fg, bg, palette[16];
-    gdk_rgba_parse(&fg, "#E5E9F0");     // normal text
-    gdk_rgba_parse(&bg, "#1E2127");     // background
-
-	gdk_rgba_parse(&palette[0], "#434C5E");  // black → slightly lighter
-	gdk_rgba_parse(&palette[1], "#BF616A");  // red
-	gdk_rgba_parse(&palette[2], "#A3BE8C");  // green
-	gdk_rgba_parse(&palette[3], "#EBCB8B");  // yellow
-	gdk_rgba_parse(&palette[4], "#81A1C1");  // blue
-	gdk_rgba_parse(&palette[5], "#B48EAD");  // magenta
-	gdk_rgba_parse(&palette[6], "#8FBCBB");  // cyan
-	gdk_rgba_parse(&palette[7], "#E5E9F0");  // white
-	gdk_rgba_parse(&palette[8], "#5E6579");  // bright black → lighter than before
-	gdk_rgba_parse(&palette[9], "#BF616A");  // bright red
-	gdk_rgba_parse(&palette[10], "#A3BE8C"); // bright green
-	gdk_rgba_parse(&palette[11], "#EBCB8B"); // bright yellow
-	gdk_rgba_parse(&palette[12], "#81A1C1"); // bright blue
-	gdk_rgba_parse(&palette[13], "#B48EAD"); // bright magenta
-	gdk_rgba_parse(&palette[14], "#8FBCBB"); // bright cyan
-	gdk_rgba_parse(&palette[15], "#ECEFF4"); // bright white
+// Parsed once and shared by every tab
+const TerminalStyle& terminal_style() {
+    static const TerminalStyle style = [] {
+        TerminalStyle s;
+        s.font = pango_font_description_from_string("Monospace 12");
 
+        // Nord-inspired colors
+        gdk_rgba_parse(&s.fg, "#E5E9F0");     // normal text
+        gdk_rgba_parse(&s.bg, "#1E2127");     // background
 
-    // Apply colors and palette
-    vte_terminal_set_colors(terminal, &fg, &bg, palette, 16);
-    vte_terminal_set_mouse_autohide(terminal, TRUE);
+        gdk_rgba_parse(&s.palette[0], "#434C5E");  // black → slightly lighter
+        gdk_rgba_parse(&s.palette[1], "#BF616A");  // red
+        gdk_rgba_parse(&s.palette[2], "#A3BE8C");  // green
+        gdk_rgba_parse(&s.palette[3], "#EBCB8B");  // yellow
+        gdk_rgba_parse(&s.palette[4], "#81A1C1");  // blue
+        gdk_rgba_parse(&s.palette[5], "#B48EAD");  // magenta
+        gdk_rgba_parse(&s.palette[6], "#8FBCBB");  // cyan
+        gdk_rgba_parse(&s.palette[7], "#E5E9F0");  // white
+        gdk_rgba_parse(&s.palette[8], "#5E6579");  // bright black → lighter than before
+        gdk_rgba_parse(&s.palette[9], "#BF616A");  // bright red
+        gdk_rgba_parse(&s.palette[10], "#A3BE8C"); // bright green
+        gdk_rgba_parse(&s.palette[11], "#EBCB8B"); // bright yellow
+        gdk_rgba_parse(&s.palette[12], "#81A1C1"); // bright blue
+        gdk_rgba_parse(&s.palette[13], "#B48EAD"); // bright magenta
+        gdk_rgba_parse(&s.palette[14], "#8FBCBB"); // bright cyan
+        gdk_rgba_parse(&s.palette[15], "#ECEFF4"); // bright white
 
-    // Spawn shell
-    struct passwd *pw = getpwuid(getuid());
-    const char* shell = pw->pw_shell ? pw->pw_shell : "/bin/bash";
-    char *argv_shell[] = {(char*)shell, nullptr};
+        struct passwd *pw = getpwuid(getuid());
+        s.shell = pw && pw->pw_shell ? pw->pw_shell : "/bin/bash";
+        return s;
+    }();
+    return style;
+}
 
-    vte_terminal_spawn_async(
-        terminal,
-        VTE_PTY_DEFAULT,
-        nullptr,
-        argv_shell,
-        nullptr,
-        G_SPAWN_DEFAULT,
-        nullptr, nullptr,
-        nullptr,
-        -1,
-        nullptr,
-        nullptr, nullptr
-    );
+void terminal_notice(VteTerminal *terminal, const std::string &text) {
+    std::string line = "\r\n\033[1m[" + text + "]\033[0m\r\n";
+    vte_terminal_feed(terminal, line.c_str(), line.size());
+}
+
+bool start_session_log(VteTerminal *terminal) {
+    Tab *tab = tab_for(terminal);
+    if (!tab || !tab->relay) {
+        terminal_notice(terminal, "session logging needs a child running on its own PTY");
+        return false;
+    }
+    if (pty_relay_log(tab->relay)) return true;
+
+    static guint log_serial = 0;
+    const MiniTConfig &config = mini_t_config();
+    g_mkdir_with_parents(config.session_log_dir.c_str(), 0700);
+
+    GDateTime *now = g_date_time_new_now_local();
+    char *stamp = g_date_time_format(now, "%Y%m%d-%H%M%S");
+    char *name = g_strdup_printf("mini-t-%s-%d-%u.log%s", stamp, (int)getpid(), ++log_serial,
+                                 config.session_log_compress ? ".gz" : "");
+    char *path = g_build_filename(config.session_log_dir.c_str(), name, NULL);
+
+    SessionLog *log = session_log_open(path, config.session_log_compress, config.session_log_timestamps);
+    char *notice = log ? g_strdup_printf("logging session to %s", path)
+                       : g_strdup_printf("cannot create session log %s", path);
+    terminal_notice(terminal, notice);
+    if (log) pty_relay_set_log(tab->relay, log);
+
+    g_free(notice);
+    g_free(path);
+    g_free(name);
+    g_free(stamp);
+    g_date_time_unref(now);
+    return log != nullptr;
+}
+
+void stop_session_log(VteTerminal *terminal) {
+    Tab *tab = tab_for(terminal);
+    SessionLog *log = tab && tab->relay ? pty_relay_log(tab->relay) : nullptr;
+    if (!log) return;
+
+    // The relay closes the log once it lets go of it; read the counters first
+    SessionLogStats stats = session_log_stats(log);
+    pty_relay_set_log(tab->relay, nullptr);
+    char *notice = g_strdup_printf("session log closed: %llu bytes written, %llu writes (%llu bytes) dropped",
+                                   (unsigned long long)stats.written_bytes,
+                                   (unsigned long long)stats.dropped_writes,
+                                   (unsigned long long)stats.dropped_bytes);
+    terminal_notice(terminal, notice);
+    g_free(notice);
+}
+
+VteTerminal* new_terminal(bool splash) {
+    const TerminalStyle &style = terminal_style();
+    VteTerminal *terminal = VTE_TERMINAL(vte_terminal_new());
+    vte_terminal_set_scrollback_lines(terminal, mini_t_config().scrollback_lines);
+    vte_terminal_set_font(terminal, style.font);
+
+    // Apply colors and palette
+    vte_terminal_set_colors(terminal, &style.fg, &style.bg, style.palette, 16);
+    vte_terminal_set_mouse_autohide(terminal, TRUE);
 
     // Splash screen
     if (splash && !splash_shown) {
@@ -74,5 +124,119 @@ VteTerminal* spawn_terminal(GtkWidget *parent, bool splash) {
     gtk_widget_set_hexpand(GTK_WIDGET(terminal), TRUE);
     gtk_widget_set_vexpand(GTK_WIDGET(terminal), TRUE);
 
+    tab_attach(terminal);
+    search_attach(terminal);
+    return terminal;
+}
+
+bool session_log_active(VteTerminal *terminal) {
+    Tab *tab = tab_for(terminal);
+    return tab && tab->relay && pty_relay_log(tab->relay);
+}
+
+char** terminal_child_environ() {
+    char **envv = g_get_environ();
+    envv = g_environ_setenv(envv, "TERM", "xterm-256color", TRUE);
+    envv = g_environ_setenv(envv, "COLORTERM", "truecolor", TRUE);
+    char *vte_version = g_strdup_printf("%u", vte_get_major_version() * 10000 + vte_get_minor_version() * 100 + vte_get_micro_version());
+    envv = g_environ_setenv(envv, "VTE_VERSION", vte_version, TRUE);
+    g_free(vte_version);
+    return envv;
+}
+
+void terminal_adopt_child(VteTerminal *terminal, VtePty *pty, GPid pid) {
+    PtyRelay *relay = pty_relay_attach(terminal, pty);
+    // Without a relay the child still runs, just on the terminal's PTY directly
+    if (!relay) vte_terminal_set_pty(terminal, pty);
+    tab_set_child(terminal, pid, pty, relay);
+    if (relay && mini_t_config().session_log_all) start_session_log(terminal);
+}
+
+struct PendingSpawn {
+    VteTerminal *terminal; // referenced until the spawn finishes
+    VteTerminalSpawnAsyncCallback callback;
+    gpointer user_data;
+};
+
+static void on_orphan_reaped(GPid pid, gint, gpointer) {
+    g_spawn_close_pid(pid);
+}
+
+static void on_child_spawned(GObject *source, GAsyncResult *result, gpointer user_data) {
+    VtePty *pty = VTE_PTY(source);
+    PendingSpawn *spawn = (PendingSpawn*)user_data;
+    GPid pid = -1;
+    GError *error = nullptr;
+
+    bool spawned = vte_pty_spawn_finish(pty, result, &pid, &error);
+    if (!tab_for(spawn->terminal)) {
+        // The tab was closed while the child started
+        if (spawned) {
+            kill(pid, SIGHUP);
+            g_child_watch_add(pid, on_orphan_reaped, nullptr);
+        }
+    } else {
+        if (spawned) terminal_adopt_child(spawn->terminal, pty, pid);
+        if (spawn->callback) spawn->callback(spawn->terminal, pid, error, spawn->user_data);
+    }
+
+    if (error) g_error_free(error);
+    g_object_unref(spawn->terminal);
+    g_object_unref(pty);
+    delete spawn;
+}
+
+void terminal_spawn(VteTerminal *terminal, char **argv, const char *workdir,
+                    VteTerminalSpawnAsyncCallback callback, gpointer user_data) {
+    GError *error = nullptr;
+    VtePty *pty = vte_pty_new_sync(VTE_PTY_DEFAULT, nullptr, &error);
+    if (!pty) {
+        if (callback) callback(terminal, -1, error, user_data);
+        g_error_free(error);
+        return;
+    }
+    vte_pty_set_size(pty, vte_terminal_get_row_count(terminal), vte_terminal_get_column_count(terminal), nullptr);
+
+    char **envv = terminal_child_environ();
+    PendingSpawn *spawn = new PendingSpawn{VTE_TERMINAL(g_object_ref(terminal)), callback, user_data};
+    vte_pty_spawn_async(
+        pty,
+        workdir,
+        argv,
+        envv,
+        (GSpawnFlags)(G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH),
+        nullptr, nullptr,
+        nullptr,
+        -1,
+        nullptr,
+        on_child_spawned,
+        spawn
+    );
+    g_strfreev(envv);
+}
+
+static void on_shell_spawned(VteTerminal *terminal, GPid pid, GError *error, gpointer) {
+    if (error) terminal_notice(terminal, std::string("failed to start shell: ") + error->message);
+    else vte_terminal_watch_child(terminal, pid);
+}
+
+VteTerminal* spawn_terminal(GtkWidget *parent, bool splash) {
+    TRACE_SCOPE("spawn_terminal");
+    (void)parent; // unused
+    VteTerminal *terminal = new_terminal(splash);
+
+    // Adopt a warm shell when one is ready, otherwise fork one now
+    PooledShell pooled = {nullptr, -1};
+    if (shell_pool_take(&pooled)) {
+        TRACE_INSTANT("adopted pooled shell");
+        terminal_adopt_child(terminal, pooled.pty, pooled.pid);
+        vte_terminal_watch_child(terminal, pooled.pid);
+        g_object_unref(pooled.pty);
+        return terminal;
+    }
+
+    char *argv_shell[] = {(char*)terminal_style().shell.c_str(), nullptr};
+    terminal_spawn(terminal, argv_shell, nullptr, on_shell_spawned, nullptr);
+
     return terminal;
 }
@@ -0,0 +1,19 @@
+#pragma once
+#include <gtk/gtk.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Files that aren't UTF-8 text open in a read-only hex view that memory-maps
+// the file and draws only visible rows. Text large enough to make a
+// GtkSourceBuffer slow and memory-hungry is flagged so the user can choose,
+// and text past a hard limit opens as hex only.
+enum FileKind { FILE_TEXT, FILE_LARGE_TEXT, FILE_BINARY };
+FileKind classify_file(const std::string &path);
+
+// The tab's page widget, or nullptr with errno set if the file can't be mapped
+GtkWidget* hex_view_new(const std::string &path);
+
+// Offset of the first needle in haystack, or SIZE_MAX. Candidates are found
+// 16 bytes at a time by matching the needle's first and last byte with SSE2.
+size_t find_bytes(const uint8_t *haystack, size_t len, const uint8_t *needle, size_t needle_len);
@@ -0,0 +1,458 @@
+#include "hex_view.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static const size_t BYTES_PER_ROW = 16;
+static const size_t SNIFF_BYTES = 64 * 1024;
+static const guint64 LARGE_TEXT_BYTES = 64 * 1024 * 1024;
+static const guint64 HEX_ONLY_BYTES = 1024 * 1024 * 1024;
+static const size_t SEARCH_CHUNK_BYTES = 64 * 1024 * 1024;
+static const int PADDING = 6;
+
+struct HexView {
+    int fd;
+    const uint8_t *data; // nullptr for empty files
+    size_t mapped;       // length of the mapping
+    size_t size;         // bytes still in the file, at most mapped
+    int offset_digits;
+
+    GtkWidget *box;
+    GtkWidget *area;
+    GtkWidget *offset_entry;
+    GtkWidget *search_entry;
+    GtkWidget *status;
+    GtkAdjustment *adj; // in rows
+    PangoFontDescription *font;
+    double char_width;
+    int line_height;
+
+    size_t cursor;    // start of the highlighted bytes
+    size_t match_len; // 0 when nothing is highlighted
+
+    std::vector<uint8_t> pattern;
+    size_t search_pos;
+    guint search_source;
+};
+
+// -------------------- Detection --------------------
+FileKind classify_file(const std::string &path) {
+    struct stat st;
+    // Unreadable paths go to the text loader, which reports the error
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return FILE_TEXT;
+    // Past this a GtkSourceBuffer would need several GiB, so don't offer it
+    if ((guint64)st.st_size > HEX_ONLY_BYTES) return FILE_BINARY;
+    FileKind text = (guint64)st.st_size > LARGE_TEXT_BYTES ? FILE_LARGE_TEXT : FILE_TEXT;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return text;
+    std::vector<char> buf(SNIFF_BYTES);
+    ssize_t n = read(fd, buf.data(), buf.size());
+    close(fd);
+    if (n <= 0) return text;
+
+    if (memchr(buf.data(), '\0', n)) return FILE_BINARY;
+    const gchar *end;
+    if (g_utf8_validate(buf.data(), n, &end)) return text;
+    // The sample may have cut a multi-byte character in half
+    return (size_t)n == SNIFF_BYTES && buf.data() + n - end < 4 ? text : FILE_BINARY;
+}
+
+// -------------------- Searching --------------------
+size_t find_bytes(const uint8_t *haystack, size_t len, const uint8_t *needle, size_t needle_len) {
+    if (needle_len == 0 || len < needle_len) return SIZE_MAX;
+    if (needle_len == 1) {
+        const void *hit = memchr(haystack, needle[0], len);
+        return hit ? (const uint8_t*)hit - haystack : SIZE_MAX;
+    }
+
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8((char)needle[0]);
+    const __m128i last = _mm_set1_epi8((char)needle[needle_len - 1]);
+    for (; i + needle_len - 1 + 16 <= len; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(haystack + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(haystack + i + needle_len - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                                        _mm_cmpeq_epi8(last, block_last)));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (memcmp(haystack + i + bit + 1, needle + 1, needle_len - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + needle_len <= len; i++)
+        if (haystack[i] == needle[0] && memcmp(haystack + i, needle, needle_len) == 0) return i;
+    return SIZE_MAX;
+}
+
+// "de ad be ef" / "deadbeef" as bytes, anything else (or "quoted") as text
+static void parse_pattern(const char *text, std::vector<uint8_t> &out) {
+    out.clear();
+    size_t len = strlen(text);
+    if (len >= 2 && text[0] == '"' && text[len - 1] == '"') {
+        out.assign(text + 1, text + len - 1);
+        return;
+    }
+
+    std::string digits;
+    bool is_hex = true;
+    for (const char *c = text; *c && is_hex; c++) {
+        if (g_ascii_isxdigit(*c)) digits += *c;
+        else is_hex = (*c == ' ' || *c == ':');
+    }
+    if (!is_hex || digits.empty() || digits.size() % 2 != 0) {
+        out.assign(text, text + len);
+        return;
+    }
+    for (size_t i = 0; i < digits.size(); i += 2)
+        out.push_back((uint8_t)(g_ascii_xdigit_value(digits[i]) * 16 + g_ascii_xdigit_value(digits[i + 1])));
+}
+
+// -------------------- Rendering --------------------
+static int hex_column(const HexView *hv, size_t i) {
+    return hv->offset_digits + 2 + (int)i * 3 + (i >= 8 ? 1 : 0);
+}
+
+static int ascii_column(const HexView *hv, size_t i) {
+    return hv->offset_digits + 2 + (int)BYTES_PER_ROW * 3 + 2 + (int)i;
+}
+
+static void format_row(const HexView *hv, guint64 offset, std::string &out) {
+    static const char digits[] = "0123456789abcdef";
+    char prefix[32];
+    std::snprintf(prefix, sizeof(prefix), "%0*llx  ", hv->offset_digits, (unsigned long long)offset);
+    out += prefix;
+
+    size_t n = std::min<guint64>(BYTES_PER_ROW, hv->size - offset);
+    const uint8_t *row = hv->data + offset;
+    for (size_t i = 0; i < BYTES_PER_ROW; i++) {
+        if (i == 8) out += ' ';
+        if (i < n) {
+            out += digits[row[i] >> 4];
+            out += digits[row[i] & 15];
+            out += ' ';
+        } else {
+            out += "   ";
+        }
+    }
+    out += '|';
+    for (size_t i = 0; i < n; i++) out += row[i] >= 0x20 && row[i] < 0x7f ? (char)row[i] : '.';
+    out += "|\n";
+}
+
+static void ensure_metrics(HexView *hv) {
+    if (hv->line_height > 0) return;
+    PangoLayout *layout = gtk_widget_create_pango_layout(hv->area, "0000000000000000");
+    pango_layout_set_font_description(layout, hv->font);
+    int width, height;
+    pango_layout_get_size(layout, &width, &height);
+    hv->char_width = (double)width / PANGO_SCALE / 16;
+    hv->line_height = std::max(1, height / PANGO_SCALE);
+    g_object_unref(layout);
+}
+
+static guint64 total_rows(const HexView *hv) {
+    return (hv->size + BYTES_PER_ROW - 1) / BYTES_PER_ROW;
+}
+
+// Touching a mapped page past the end of a file that was truncated after it
+// was opened raises SIGBUS, so the size is rechecked before every access.
+// A file that grows keeps showing the mapped length.
+static void refresh_size(HexView *hv) {
+    struct stat st;
+    if (fstat(hv->fd, &st) != 0 || (size_t)st.st_size >= hv->size) return;
+    hv->size = st.st_size;
+    if (hv->cursor + hv->match_len > hv->size) hv->match_len = 0;
+    gtk_adjustment_set_upper(hv->adj, (double)total_rows(hv));
+}
+
+static void update_status(HexView *hv) {
+    guint64 top = (guint64)gtk_adjustment_get_value(hv->adj) * BYTES_PER_ROW;
+    char *text = hv->match_len
+        ? g_strdup_printf("0x%llx of 0x%llx bytes — selected 0x%llx (%zu bytes)",
+                          (unsigned long long)top, (unsigned long long)hv->size,
+                          (unsigned long long)hv->cursor, hv->match_len)
+        : g_strdup_printf("0x%llx of 0x%llx bytes", (unsigned long long)top, (unsigned long long)hv->size);
+    gtk_label_set_text(GTK_LABEL(hv->status), text);
+    g_free(text);
+}
+
+static void highlight_range(HexView *hv, cairo_t *cr, guint64 first_row, int rows) {
+    guint64 view_start = first_row * BYTES_PER_ROW;
+    guint64 view_end = std::min<guint64>(hv->size, (first_row + rows) * BYTES_PER_ROW);
+    guint64 start = std::max<guint64>(hv->cursor, view_start);
+    guint64 end = std::min<guint64>(hv->cursor + hv->match_len, view_end);
+
+    cairo_set_source_rgba(cr, 1.0, 0.8, 0.2, 0.5);
+    for (guint64 offset = start; offset < end; offset++) {
+        size_t col = offset % BYTES_PER_ROW;
+        double y = (double)(offset / BYTES_PER_ROW - first_row) * hv->line_height;
+        cairo_rectangle(cr, PADDING + hex_column(hv, col) * hv->char_width, y, 2 * hv->char_width, hv->line_height);
+        cairo_rectangle(cr, PADDING + ascii_column(hv, col) * hv->char_width, y, hv->char_width, hv->line_height);
+    }
+    cairo_fill(cr);
+}
+
+// Only the rows in view are formatted; the rest of the mapping is never touched
+static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+    HexView *hv = (HexView*)user_data;
+    ensure_metrics(hv);
+    refresh_size(hv);
+
+    int width = gtk_widget_get_allocated_width(widget);
+    int height = gtk_widget_get_allocated_height(widget);
+    GtkStyleContext *style = gtk_widget_get_style_context(widget);
+    gtk_render_background(style, cr, 0, 0, width, height);
+
+    guint64 first_row = (guint64)gtk_adjustment_get_value(hv->adj);
+    int rows = height / hv->line_height + 1;
+    if (hv->match_len) highlight_range(hv, cr, first_row, rows);
+
+    std::string text;
+    for (int r = 0; r < rows && first_row + r < total_rows(hv); r++)
+        format_row(hv, (first_row + r) * BYTES_PER_ROW, text);
+
+    PangoLayout *layout = gtk_widget_create_pango_layout(widget, text.c_str());
+    pango_layout_set_font_description(layout, hv->font);
+    GdkRGBA fg;
+    gtk_style_context_get_color(style, gtk_style_context_get_state(style), &fg);
+    gdk_cairo_set_source_rgba(cr, &fg);
+    cairo_move_to(cr, PADDING, 0);
+    pango_cairo_show_layout(cr, layout);
+    g_object_unref(layout);
+    return TRUE;
+}
+
+static void configure_adjustment(HexView *hv) {
+    ensure_metrics(hv);
+    double page = std::max(1, gtk_widget_get_allocated_height(hv->area) / hv->line_height);
+    gtk_adjustment_configure(hv->adj, gtk_adjustment_get_value(hv->adj), 0, (double)total_rows(hv),
+                             1, std::max(1.0, page - 1), page);
+}
+
+static void on_size_allocate(GtkWidget*, GdkRectangle*, gpointer user_data) {
+    configure_adjustment((HexView*)user_data);
+}
+
+static void on_scrolled(GtkAdjustment*, gpointer user_data) {
+    HexView *hv = (HexView*)user_data;
+    gtk_widget_queue_draw(hv->area);
+    update_status(hv);
+}
+
+static void scroll_by(HexView *hv, double rows) {
+    gtk_adjustment_set_value(hv->adj, gtk_adjustment_get_value(hv->adj) + rows);
+}
+
+static void scroll_to_offset(HexView *hv, guint64 offset) {
+    double row = (double)(offset / BYTES_PER_ROW);
+    gtk_adjustment_set_value(hv->adj, row - gtk_adjustment_get_page_size(hv->adj) / 2);
+    gtk_widget_queue_draw(hv->area);
+    update_status(hv);
+}
+
+static gboolean on_scroll(GtkWidget*, GdkEventScroll *event, gpointer user_data) {
+    HexView *hv = (HexView*)user_data;
+    if (event->direction == GDK_SCROLL_UP) scroll_by(hv, -3);
+    else if (event->direction == GDK_SCROLL_DOWN) scroll_by(hv, 3);
+    else if (event->direction == GDK_SCROLL_SMOOTH) scroll_by(hv, event->delta_y * 3);
+    return TRUE;
+}
+
+static gboolean on_key_press(GtkWidget*, GdkEventKey *event, gpointer user_data) {
+    HexView *hv = (HexView*)user_data;
+    double page = gtk_adjustment_get_page_size(hv->adj);
+    switch (event->keyval) {
+        case GDK_KEY_Up: scroll_by(hv, -1); return TRUE;
+        case GDK_KEY_Down: scroll_by(hv, 1); return TRUE;
+        case GDK_KEY_Page_Up: scroll_by(hv, -page); return TRUE;
+        case GDK_KEY_Page_Down: scroll_by(hv, page); return TRUE;
+        case GDK_KEY_Home: gtk_adjustment_set_value(hv->adj, 0); return TRUE;
+        case GDK_KEY_End: gtk_adjustment_set_value(hv->adj, (double)total_rows(hv)); return TRUE;
+        default: return FALSE;
+    }
+}
+
+static gboolean on_button_press(GtkWidget *widget, GdkEventButton*, gpointer) {
+    gtk_widget_grab_focus(widget);
+    return FALSE;
+}
+
+// -------------------- Toolbar --------------------
+static void on_offset_activate(GtkEntry *entry, gpointer user_data) {
+    HexView *hv = (HexView*)user_data;
+    const char *text = gtk_entry_get_text(entry);
+    char *end = nullptr;
+    errno = 0;
+    guint64 offset = g_ascii_strtoull(text, &end, 0); // 0x prefix for hex, else decimal
+    refresh_size(hv);
+    if (errno || end == text || *end != '\0' || offset >= hv->size) {
+        gtk_label_set_text(GTK_LABEL(hv->status), "Offset out of range");
+        return;
+    }
+    hv->cursor = offset;
+    hv->match_len = 1;
+    scroll_to_offset(hv, offset);
+}
+
+// Scanned pages are dropped from the mapping again so a full pass over a huge
+// file doesn't grow RSS; the page cache still has them if they're needed
+static void release_pages(HexView *hv, size_t start, size_t end) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t aligned = start / page * page;
+    madvise((void*)(hv->data + aligned), end - aligned, MADV_DONTNEED);
+}
+
+static gboolean search_step(gpointer user_data) {
+    TRACE_SCOPE("hex search chunk");
+    HexView *hv = (HexView*)user_data;
+    refresh_size(hv);
+    size_t start = std::min(hv->search_pos, hv->size);
+    // Overlap chunks by the pattern length so boundary-spanning matches are found
+    size_t end = std::min(hv->size, start + SEARCH_CHUNK_BYTES + hv->pattern.size() - 1);
+    size_t found = find_bytes(hv->data + start, end - start, hv->pattern.data(), hv->pattern.size());
+    release_pages(hv, start, end);
+
+    if (found != SIZE_MAX) {
+        hv->search_source = 0;
+        hv->cursor = start + found;
+        hv->match_len = hv->pattern.size();
+        scroll_to_offset(hv, hv->cursor);
+        return G_SOURCE_REMOVE;
+    }
+    if (end >= hv->size) {
+        hv->search_source = 0;
+        gtk_label_set_text(GTK_LABEL(hv->status), "Pattern not found");
+        return G_SOURCE_REMOVE;
+    }
+
+    hv->search_pos = start + SEARCH_CHUNK_BYTES;
+    char *progress = g_strdup_printf("Searching… %d%%", (int)(hv->search_pos * 100.0 / hv->size));
+    gtk_label_set_text(GTK_LABEL(hv->status), progress);
+    g_free(progress);
+    return G_SOURCE_CONTINUE;
+}
+
+// Enter searches forward from the current match, so repeating it finds the next one
+static void on_search_activate(GtkEntry *entry, gpointer user_data) {
+    HexView *hv = (HexView*)user_data;
+    if (hv->search_source) g_source_remove(hv->search_source);
+    hv->search_source = 0;
+
+    parse_pattern(gtk_entry_get_text(entry), hv->pattern);
+    if (hv->pattern.empty() || !hv->data) return;
+    refresh_size(hv);
+
+    hv->search_pos = hv->match_len ? hv->cursor + 1
+                                   : (size_t)gtk_adjustment_get_value(hv->adj) * BYTES_PER_ROW;
+    if (hv->search_pos >= hv->size) {
+        gtk_label_set_text(GTK_LABEL(hv->status), "Pattern not found");
+        return;
+    }
+    // Chunks run at idle priority so the window stays responsive on huge files
+    hv->search_source = g_idle_add(search_step, hv);
+}
+
+static void on_destroy(GtkWidget*, gpointer user_data) {
+    HexView *hv = (HexView*)user_data;
+    if (hv->search_source) g_source_remove(hv->search_source);
+    if (hv->data) munmap((void*)hv->data, hv->mapped);
+    close(hv->fd);
+    pango_font_description_free(hv->font);
+    delete hv;
+}
+
+GtkWidget* hex_view_new(const std::string &path) {
+    TRACE_SCOPE("hex_view_new");
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return nullptr;
+    }
+
+    // Mapping is O(1) regardless of size; pages fault in only when a row is drawn
+    const uint8_t *data = nullptr;
+    if (st.st_size > 0) {
+        void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return nullptr;
+        }
+        madvise(map, st.st_size, MADV_RANDOM);
+        data = (const uint8_t*)map;
+    }
+
+    HexView *hv = new HexView();
+    hv->fd = fd;
+    hv->data = data;
+    hv->mapped = st.st_size;
+    hv->size = st.st_size;
+    hv->offset_digits = 8;
+    while (hv->offset_digits < 16 && (hv->size >> (hv->offset_digits * 4)) > 0) hv->offset_digits++;
+    hv->font = pango_font_description_from_string("Monospace 10");
+    hv->line_height = 0;
+    hv->char_width = 0;
+    hv->cursor = 0;
+    hv->match_len = 0;
+    hv->search_pos = 0;
+    hv->search_source = 0;
+
+    hv->box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+
+    GtkWidget *toolbar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    gtk_container_set_border_width(GTK_CONTAINER(toolbar), 4);
+    hv->offset_entry = gtk_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(hv->offset_entry), "Go to offset (0x… or decimal)");
+    hv->search_entry = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(hv->search_entry), "Find bytes: de ad be ef or \"text\"");
+    hv->status = gtk_label_new("");
+    gtk_box_pack_start(GTK_BOX(toolbar), hv->offset_entry, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(toolbar), hv->search_entry, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(toolbar), hv->status, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hv->box), toolbar, FALSE, FALSE, 0);
+
+    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+    hv->adj = gtk_adjustment_new(0, 0, (double)total_rows(hv), 1, 10, 10);
+    hv->area = gtk_drawing_area_new();
+    gtk_widget_set_can_focus(hv->area, TRUE);
+    gtk_widget_add_events(hv->area, GDK_SCROLL_MASK | GDK_SMOOTH_SCROLL_MASK | GDK_KEY_PRESS_MASK | GDK_BUTTON_PRESS_MASK);
+    gtk_widget_set_hexpand(hv->area, TRUE);
+    gtk_widget_set_vexpand(hv->area, TRUE);
+    GtkWidget *scrollbar = gtk_scrollbar_new(GTK_ORIENTATION_VERTICAL, hv->adj);
+    gtk_box_pack_start(GTK_BOX(hbox), hv->area, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), scrollbar, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hv->box), hbox, TRUE, TRUE, 0);
+
+    g_signal_connect(hv->area, "draw", G_CALLBACK(on_draw), hv);
+    g_signal_connect(hv->area, "size-allocate", G_CALLBACK(on_size_allocate), hv);
+    g_signal_connect(hv->area, "scroll-event", G_CALLBACK(on_scroll), hv);
+    g_signal_connect(hv->area, "key-press-event", G_CALLBACK(on_key_press), hv);
+    g_signal_connect(hv->area, "button-press-event", G_CALLBACK(on_button_press), hv);
+    g_signal_connect(hv->adj, "value-changed", G_CALLBACK(on_scrolled), hv);
+    g_signal_connect(hv->offset_entry, "activate", G_CALLBACK(on_offset_activate), hv);
+    g_signal_connect(hv->search_entry, "activate", G_CALLBACK(on_search_activate), hv);
+    g_signal_connect(hv->box, "destroy", G_CALLBACK(on_destroy), hv);
+
+    update_status(hv);
+    return hv->box;
+}
@@ -2,6 +2,8 @@
 #include <gtk/gtk.h>
 #include <gtksourceview/gtksource.h>
 #include <vte/vte.h>
+#include "trace.hpp"
+#include "hex_view.hpp"
 
 #include <string>
 #include <vector>
@@ -10,10 +12,13 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
 
 struct TabData {
-    GtkWidget* scrolled;
-    GtkSourceBuffer* buffer;
+    GtkWidget* scrolled;      // notebook page
+    GtkSourceBuffer* buffer;  // nullptr for read-only hex tabs
     GtkWidget* view;
     std::string path;
     bool dirty;
@@ -30,6 +35,12 @@ static GtkWidget* paned;     // vertical paned (top: notebook, bottom: terminal)
 #define UNUSED(x) (void)(x)
 
 static void update_status_for_buffer(TabData *t) {
+    if (!t->buffer) {
+        std::string label = t->path + " — read-only hex view";
+        gtk_statusbar_pop(GTK_STATUSBAR(statusbar), status_ctx);
+        gtk_statusbar_push(GTK_STATUSBAR(statusbar), status_ctx, label.c_str());
+        return;
+    }
     GtkTextIter iter;
     gtk_text_buffer_get_iter_at_mark(GTK_TEXT_BUFFER(t->buffer),
                                      &iter,
@@ -127,12 +138,35 @@ static TabData* create_new_tab(const std::string &initial_text = "", const std::
     return t;
 }
 
+static bool open_hex_tab(const std::string &path) {
+    GtkWidget *page_widget = hex_view_new(path);
+    if (!page_widget) return false;
+
+    auto tab = std::make_unique<TabData>();
+    tab->scrolled = page_widget;
+    tab->buffer = nullptr;
+    tab->view = nullptr;
+    tab->path = path;
+    tab->dirty = false;
+    gtk_widget_show_all(tab->scrolled);
+
+    gint page = gtk_notebook_append_page(GTK_NOTEBOOK(notebook), tab->scrolled, NULL);
+    tabs.push_back(std::move(tab));
+    TabData* t = tabs.back().get();
+    ensure_tab_label(t);
+    gtk_notebook_set_current_page(GTK_NOTEBOOK(notebook), page);
+    update_status_for_buffer(t);
+    return true;
+}
+
 static bool load_file_to_tab(TabData* t, const std::string &path) {
+    TRACE_SCOPE("load_file_to_tab");
     std::ifstream ifs(path, std::ios::binary);
     if (!ifs) return false;
     std::ostringstream ss;
     ss << ifs.rdbuf();
     std::string content = ss.str();
+    TRACE_COUNTER("loaded bytes", content.size());
     gtk_text_buffer_set_text(GTK_TEXT_BUFFER(t->buffer), content.c_str(), content.size());
     t->path = path;
     mark_tab_dirty(t, false);
@@ -141,6 +175,7 @@ static bool load_file_to_tab(TabData* t, const std::string &path) {
 }
 
 static bool save_tab_to_path(TabData* t, const std::string &path) {
+    TRACE_SCOPE("save_tab_to_path");
     GtkTextIter start, end;
     gtk_text_buffer_get_start_iter(GTK_TEXT_BUFFER(t->buffer), &start);
     gtk_text_buffer_get_end_iter(GTK_TEXT_BUFFER(t->buffer), &end);
@@ -152,6 +187,7 @@ static bool save_tab_to_path(TabData* t, const std::string &path) {
         return false;
     }
     ofs << text;
+    TRACE_COUNTER("saved bytes", strlen(text));
     ofs.close();
     g_free(text);
     t->path = path;
@@ -160,6 +196,25 @@ static bool save_tab_to_path(TabData* t, const std::string &path) {
     return true;
 }
 
+// Loading huge text into a GtkSourceBuffer is slow and needs several times the
+// file size in memory, so offer the hex view first
+static FileKind ask_large_text(const char *filename) {
+    GtkWidget *dialog = gtk_message_dialog_new(
+        GTK_WINDOW(gtk_widget_get_toplevel(notebook)),
+        GTK_DIALOG_MODAL,
+        GTK_MESSAGE_QUESTION,
+        GTK_BUTTONS_NONE,
+        "%s is large. Open it as editable text anyway?", filename);
+    gtk_dialog_add_buttons(GTK_DIALOG(dialog),
+                           "Open as _Hex", GTK_RESPONSE_REJECT,
+                           "Open as _Text", GTK_RESPONSE_ACCEPT,
+                           NULL);
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_REJECT);
+    gint response = gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+    return response == GTK_RESPONSE_ACCEPT ? FILE_TEXT : FILE_BINARY;
+}
+
 // File menu actions
 static void action_new(GtkWidget*, gpointer) { create_new_tab(); }
 
@@ -174,8 +229,12 @@ static void action_open(GtkWidget*, gpointer) {
 
     if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
         char *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
-        TabData* t = create_new_tab();
-        if (!load_file_to_tab(t, filename)) {
+        FileKind kind = classify_file(filename);
+        if (kind == FILE_LARGE_TEXT) kind = ask_large_text(filename);
+        bool opened = kind == FILE_BINARY
+            ? open_hex_tab(filename)
+            : load_file_to_tab(create_new_tab(), filename);
+        if (!opened) {
             GtkWidget *err = gtk_message_dialog_new(
                 GTK_WINDOW(gtk_widget_get_toplevel(notebook)),
                 GTK_DIALOG_MODAL,
@@ -192,7 +251,7 @@ static void action_open(GtkWidget*, gpointer) {
 
 static void action_save_as(GtkWidget*, gpointer) {
     TabData* t = get_current_tab();
-    if (!t) return;
+    if (!t || !t->buffer) return;
 
     GtkWidget *dialog = gtk_file_chooser_dialog_new(
         "Save File As",
@@ -222,7 +281,7 @@ static void action_save_as(GtkWidget*, gpointer) {
 
 static void action_save(GtkWidget*, gpointer) {
     TabData* t = get_current_tab();
-    if (!t) return;
+    if (!t || !t->buffer) return;
     if (t->path.empty()) action_save_as(nullptr, nullptr);
     else save_tab_to_path(t, t->path);
 }
@@ -244,40 +303,132 @@ static void action_close_tab(GtkWidget*, gpointer) {
 
 static void action_quit(GtkWidget*, gpointer) { gtk_main_quit(); }
 
-// Modern VTE terminal
-static void create_terminal() {
-    terminal = vte_terminal_new();
+// Startup phases: process start -> main -> first frame -> interactive. Each is
+// a trace instant (TRACE_OUTPUT); TEXT_EDIT_TRACE_STARTUP=1 also prints them.
+static uint64_t startup_process_ns;
+static uint64_t startup_main_ns;
+static uint64_t startup_first_frame_ns;
+static bool startup_print = false;
+
+static uint64_t startup_mark(const char *name) {
+    uint64_t now = trace::now_ns();
+    trace::instant_at(name, now);
+    return now;
+}
+
+// Time the kernel started this process on the trace::now_ns() clock, or 0
+static uint64_t process_start_ns() {
+    std::ifstream stat_file("/proc/self/stat");
+    std::string line;
+    if (!std::getline(stat_file, line)) return 0;
+
+    // Field 22 (starttime) counts from the closing paren of comm, which may contain spaces
+    size_t paren = line.rfind(')');
+    if (paren == std::string::npos) return 0;
+    std::istringstream fields(line.substr(paren + 2));
+    std::string field;
+    for (int i = 3; i <= 22; i++)
+        if (!(fields >> field)) return 0;
+
+    struct timespec boot;
+    if (clock_gettime(CLOCK_BOOTTIME, &boot) != 0) return 0;
+    uint64_t boot_ns = (uint64_t)boot.tv_sec * 1000000000 + boot.tv_nsec;
+    uint64_t start_ns = std::stoull(field) * 1000000000 / sysconf(_SC_CLK_TCK);
+    return trace::now_ns() - (boot_ns - start_ns);
+}
+
+static gboolean on_startup_interactive(gpointer) {
+    uint64_t interactive_ns = startup_mark("interactive");
+    if (!startup_print) return G_SOURCE_REMOVE;
+
+    if (startup_process_ns)
+        g_printerr("startup: process start -> main %.1f ms\n", (startup_main_ns - startup_process_ns) / 1e6);
+    g_printerr("startup: main -> first frame %.1f ms\n", (startup_first_frame_ns - startup_main_ns) / 1e6);
+    g_printerr("startup: first frame -> interactive %.1f ms\n", (interactive_ns - startup_first_frame_ns) / 1e6);
+    g_printerr("startup: total (main -> interactive) %.1f ms\n", (interactive_ns - startup_main_ns) / 1e6);
+    return G_SOURCE_REMOVE;
+}
+
+// Modern VTE terminal, spawned lazily the first time it is shown
+static bool terminal_spawned = false;
+
+static void on_terminal_spawned(VteTerminal*, GPid, GError *error, gpointer) {
+    if (error) {
+        g_printerr("Failed to spawn terminal: %s\n", error->message);
+        terminal_spawned = false; // allow a retry on the next reveal
+    }
+}
+
+static void spawn_terminal_shell() {
+    if (terminal_spawned) return;
+    terminal_spawned = true;
+    TRACE_SCOPE("spawn_terminal_shell");
 
 	const char *shell = g_getenv("SHELL");
 	if (!shell) shell = "bash";
 	char *argv[] = { (char*)shell, nullptr }; // cast to char* for argv
 
-    GPid child_pid;
-    GError *error = nullptr;
-
-    gboolean success = vte_terminal_spawn_sync(
+    vte_terminal_spawn_async(
         VTE_TERMINAL(terminal),
         VTE_PTY_DEFAULT,
         nullptr,
         argv,
         nullptr,
-        G_SPAWN_DEFAULT,
+        G_SPAWN_SEARCH_PATH,
+        nullptr, nullptr,
         nullptr,
+        -1,
         nullptr,
-        &child_pid,
-        nullptr,
-        &error
+        on_terminal_spawned,
+        nullptr
     );
+}
 
-    if (!success) {
-        g_printerr("Failed to spawn terminal: %s\n", error->message);
-        g_error_free(error);
-    }
+static void on_terminal_map(GtkWidget*, gpointer) { spawn_terminal_shell(); }
 
+// Pre-warm (TEXT_EDIT_PREWARM_TERMINAL=1): fork the shell once the editor is idle
+static gboolean prewarm_terminal(gpointer) {
+    spawn_terminal_shell();
+    return G_SOURCE_REMOVE;
+}
+
+static void on_first_frame(GdkFrameClock *clock, gpointer) {
+    startup_first_frame_ns = startup_mark("first frame");
+    g_signal_handlers_disconnect_by_func(clock, (gpointer)on_first_frame, nullptr);
+
+    if (startup_print || trace::enabled())
+        g_idle_add_full(G_PRIORITY_LOW, on_startup_interactive, nullptr, nullptr);
+    if (g_strcmp0(g_getenv("TEXT_EDIT_PREWARM_TERMINAL"), "1") == 0)
+        g_idle_add_full(G_PRIORITY_LOW, prewarm_terminal, nullptr, nullptr);
+}
+
+static void create_terminal() {
+    terminal = vte_terminal_new();
     gtk_widget_set_size_request(terminal, -1, 200);
+
+    // Keep gtk_widget_show_all() from revealing (and spawning) it at startup
+    gtk_widget_set_no_show_all(terminal, TRUE);
+    g_signal_connect(terminal, "map", G_CALLBACK(on_terminal_map), nullptr);
+}
+
+static void action_toggle_terminal(GtkWidget*, gpointer) {
+    if (gtk_widget_get_visible(terminal)) {
+        gtk_widget_hide(terminal);
+    } else {
+        gtk_widget_show(terminal);
+        gtk_widget_grab_focus(terminal);
+    }
 }
 
 int main(int argc, char *argv[]) {
+    trace::init("text-editor");
+    startup_main_ns = startup_mark("main");
+    startup_print = g_strcmp0(g_getenv("TEXT_EDIT_TRACE_STARTUP"), "1") == 0;
+    if (startup_print || trace::enabled()) {
+        startup_process_ns = process_start_ns();
+        if (startup_process_ns) trace::instant_at("process start", startup_process_ns);
+    }
+
     gtk_init(&argc, &argv);
 
     GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
@@ -292,25 +443,31 @@ int main(int argc, char *argv[]) {
     GtkWidget *filemi = gtk_menu_item_new_with_label("File");
     gtk_menu_item_set_submenu(GTK_MENU_ITEM(filemi), filemenu);
 
-	auto make_item = [&](const char* label, GCallback cb, const char* accel_key) {
+	auto make_item = [&](GtkWidget* menu, const char* label, GCallback cb, const char* accel_key) {
     	GtkWidget *item = gtk_menu_item_new_with_label(label);
     	g_signal_connect(item, "activate", cb, nullptr);
     	if (accel_key) {
         	guint key = gdk_keyval_from_name(accel_key);
         	gtk_widget_add_accelerator(item, "activate", accel, key, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
     	}
-    	gtk_menu_shell_append(GTK_MENU_SHELL(filemenu), item);
+    	gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
 	};
 
 
-    make_item("New", G_CALLBACK(action_new), "n");
-    make_item("Open", G_CALLBACK(action_open), "o");
-    make_item("Save", G_CALLBACK(action_save), "s");
-    make_item("Save As", G_CALLBACK(action_save_as), nullptr);
-    make_item("Close Tab", G_CALLBACK(action_close_tab), "w");
-    make_item("Quit", G_CALLBACK(action_quit), "q");
+    make_item(filemenu, "New", G_CALLBACK(action_new), "n");
+    make_item(filemenu, "Open", G_CALLBACK(action_open), "o");
+    make_item(filemenu, "Save", G_CALLBACK(action_save), "s");
+    make_item(filemenu, "Save As", G_CALLBACK(action_save_as), nullptr);
+    make_item(filemenu, "Close Tab", G_CALLBACK(action_close_tab), "w");
+    make_item(filemenu, "Quit", G_CALLBACK(action_quit), "q");
+
+    GtkWidget *viewmenu = gtk_menu_new();
+    GtkWidget *viewmi = gtk_menu_item_new_with_label("View");
+    gtk_menu_item_set_submenu(GTK_MENU_ITEM(viewmi), viewmenu);
+    make_item(viewmenu, "Terminal", G_CALLBACK(action_toggle_terminal), "grave");
 
     gtk_menu_shell_append(GTK_MENU_SHELL(menubar), filemi);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menubar), viewmi);
 
     paned = gtk_paned_new(GTK_ORIENTATION_VERTICAL);
     gtk_container_add(GTK_CONTAINER(window), paned);
@@ -321,7 +478,6 @@ int main(int argc, char *argv[]) {
 
     create_terminal();
     gtk_paned_pack2(GTK_PANED(paned), terminal, FALSE, TRUE);
-    gtk_widget_hide(terminal);
 
     statusbar = gtk_statusbar_new();
     status_ctx = gtk_statusbar_get_context_id(GTK_STATUSBAR(statusbar), "status");
@@ -331,6 +487,7 @@ int main(int argc, char *argv[]) {
 
     g_signal_connect(window, "destroy", G_CALLBACK(gtk_main_quit), nullptr);
     gtk_widget_show_all(window);
+    g_signal_connect(gtk_widget_get_frame_clock(window), "after-paint", G_CALLBACK(on_first_frame), nullptr);
 
     gtk_main();
     return 0;